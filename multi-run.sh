@@ -5,6 +5,12 @@ V="5"
 START="1"
 STOP="10"
 
+# Runs are executed one by one; for parallel runs in one program execution use e.g.
+# ./waf --run "multi-run --nodeSpeed=5 --startRngRun=1 --stopRngRun=10 --nWorkers=8"
+# Externally controlled runs may also run concurrently (every run writes its own
+# <prefix>-Summary-run<N>.bin and rebuilds <prefix>-Summary.csv under a lock), e.g.
+# append & to the ./waf line below and add wait after the loop (build with ./waf first).
+
 echo Starting experiment...
 
 for v in $V
@@ -0,0 +1,150 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Nenad Jevtic (n.jevtic@sf.bg.ac.rs), Marija Malnar (m.malnar@sf.bg.ac.rs)
+ */
+
+// Stress scenario for StatsFlows with a very large number of flows (IoT like).
+// Sensor nodes on one CSMA LAN run many low rate StatsPacketSource applications
+// each, all sending through the gateway and a point-to-point backhaul (e.g. a
+// satellite or LPWAN backhaul, 500 ms by default) to one server. Every source
+// application is one flow, so the default configuration gives 1000 x 200 = 200000 flows.
+// At the end the memory of the flow records (bytes per flow, with the histogram
+// bins) and the peak RSS are printed, to compare histogram layouts and storage:
+//
+// Usage: ./waf --run "flows-stress --nSensors=1000 --appsPerSensor=200"
+//        ./waf --run "flows-stress --histSparse=false"  (dense per-flow histograms)
+//        ./waf --run "flows-stress --histResolution=0.000001 --histLogLinear=7"
+
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("flows-stress");
+
+int
+main (int argc, char **argv)
+{
+  uint32_t nSensors = 1000; // number of sensor nodes
+  uint32_t appsPerSensor = 200; // number of source applications (flows) per sensor node
+  uint32_t packetsPerFlow = 3; // number of packets sent by every source application
+  uint32_t packetSize = 64; // Bytes
+  std::string rate ("1kbps"); // data rate of one source application
+  double startWindow = 20.0; // [s] source applications start uniformly within this window
+  bool scalarFile = false; // per-flow scalar file is large for this many flows
+  std::string backhaulRate ("100Mbps"); // gateway - server link
+  double backhaulDelay = 500.0; // [ms] gateway - server link
+  double histResolution = 0.0001; // [s] 0.1 ms, default of StatsFlows
+  uint32_t histLogLinear = 0; // fixed width bins
+  bool histSparse = true; // per-flow histograms store only occupied bins (default of StatsFlows)
+  uint32_t port = 9;
+
+  CommandLine cmd;
+  cmd.AddValue ("nSensors", "Number of sensor nodes.", nSensors);
+  cmd.AddValue ("appsPerSensor", "Number of source applications (flows) per sensor node.", appsPerSensor);
+  cmd.AddValue ("packetsPerFlow", "Number of packets sent in every flow.", packetsPerFlow);
+  cmd.AddValue ("packetSize", "Application test packet size.", packetSize);
+  cmd.AddValue ("dataRate", "Data rate of one source application.", rate);
+  cmd.AddValue ("startWindow", "Source applications start uniformly within this time window [s].", startWindow);
+  cmd.AddValue ("scalarFile", "Write scalar file with per flow results.", scalarFile);
+  cmd.AddValue ("backhaulRate", "Data rate of the gateway - server link.", backhaulRate);
+  cmd.AddValue ("backhaulDelay", "Delay of the gateway - server link [ms].", backhaulDelay);
+  cmd.AddValue ("histResolution", "Delay histogram bin width (narrowest bin of the log-linear layout) [s].", histResolution);
+  cmd.AddValue ("histLogLinear", "Log-linear delay histograms with 2^histLogLinear bins per power of two (0 = fixed width bins).", histLogLinear);
+  cmd.AddValue ("histSparse", "Per-flow delay histograms store only occupied bins.", histSparse);
+  cmd.Parse (argc, argv);
+
+  // Nodes: gateway is node 0, server is the last node
+  NodeContainer nodes;
+  nodes.Create (nSensors + 1);
+  NodeContainer server;
+  server.Create (1);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("1Gbps"));
+  csma.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (5)));
+  NetDeviceContainer devices = csma.Install (nodes);
+
+  PointToPointHelper backhaul;
+  backhaul.SetDeviceAttribute ("DataRate", StringValue (backhaulRate));
+  backhaul.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (backhaulDelay)));
+  NetDeviceContainer backhaulDevices = backhaul.Install (nodes.Get (0), server.Get (0));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  internet.Install (server);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.0.0");
+  address.Assign (devices);
+  address.SetBase ("10.1.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer backhaulInterfaces = address.Assign (backhaulDevices);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // Sink on the server receives all flows
+  StatsSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (server.Get (0));
+  sinkApps.Start (Seconds (0.0));
+
+  // Sources
+  double flowDuration = packetsPerFlow * packetSize * 8.0 / DataRate (rate).GetBitRate ();
+  StatsSourceHelper source ("ns3::UdpSocketFactory", InetSocketAddress (backhaulInterfaces.GetAddress (1), port));
+  source.SetConstantRate (DataRate (rate), packetSize);
+  source.SetAttribute ("MaxBytes", UintegerValue (packetsPerFlow * packetSize));
+  Ptr<UniformRandomVariable> var = CreateObject<UniformRandomVariable> ();
+  for (uint32_t n = 1; n <= nSensors; ++n)
+    {
+      for (uint32_t a = 0; a < appsPerSensor; ++a)
+        {
+          ApplicationContainer sourceApps = source.Install (nodes.Get (n));
+          sourceApps.Start (Seconds (1.0 + var->GetValue (0.0, startWindow)));
+          sourceApps.Stop (Seconds (2.0 + startWindow + flowDuration));
+        }
+    }
+  double stopTime = 3.0 + startWindow + flowDuration + backhaulDelay / 1000.0;
+  sinkApps.Stop (Seconds (stopTime));
+
+  StatsFlows stats (RngSeedManager::GetRun (), "Stress", scalarFile, false);
+  stats.SetHistResolution (histResolution);
+  stats.SetHistLogLinear (histLogLinear);
+  stats.SetHistSparse (histSparse);
+
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+
+  // flow records are released by Finalize
+  uint64_t flowMemory = stats.GetFlowMemoryUsage ();
+  RunSummary srs = stats.Finalize ();
+  NS_LOG_UNCOND ("Number of Flows: " << srs.numberOfFlows << " (expected " << nSensors * appsPerSensor << ")");
+  NS_LOG_UNCOND ("Tx packets: " << srs.aap.txPackets << ", Rx packets: " << srs.aap.rxPackets);
+  NS_LOG_UNCOND ("Lost Ratio [%]: AAF " << srs.aaf.lostRatio << ", AAP "<< srs.aap.lostRatio);
+  NS_LOG_UNCOND ("E2E Delay Average [ms]: AAF " << srs.aaf.e2eDelayAverage * 1000.0 << ", AAP " << srs.aap.e2eDelayAverage * 1000.0);
+  NS_LOG_UNCOND ("Delay histograms: " << (histLogLinear > 0 ? "log-linear" : "fixed width") << ", "
+                 << (histSparse ? "sparse" : "dense") << ", resolution " << histResolution * 1000.0 << " ms");
+  NS_LOG_UNCOND ("Flow records [MB]: " << flowMemory / 1048576.0 << ", per flow [B]: "
+                 << (srs.numberOfFlows > 0 ? flowMemory / srs.numberOfFlows : 0));
+  NS_LOG_UNCOND ("Peak RSS [MB]: " << srs.peakRss / 1048576.0);
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -20,8 +20,12 @@
 
 
 
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
 
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
@@ -46,8 +50,13 @@ class RoutingExperiment
 public:
   RoutingExperiment (uint64_t stopRun = 1, std::string fn = "Net"); // default is only one simulation run
   RoutingExperiment (uint64_t startRun, uint64_t stopRun, std::string fn = "Net");
-  RunSummary Run (int argc, char **argv);
-  void WriteToSummaryFile (RunSummary srs);
+  ~RoutingExperiment ();
+  void Configure (int argc, char **argv); // command line parameters and file name prefix
+  RunSummary Run ();
+  RunSummary RunJob (uint32_t job); // one run of the parallel runs (rng run = startRngRun + job)
+  void RunSweep (); // all points of the sweep grid for all rng runs -> file: <csvFileNamePrefix>-Sweep.csv
+  RunSummary RunSweepJob (uint32_t point, uint64_t rngRun); // one run of one sweep grid point
+  void WriteToSummaryFile (RunSummary srs, bool firstRun, bool lastRun);
 
   void SetRngRun (uint64_t run) { m_rngRun = run; };
   uint64_t GetRngRun () { return m_rngRun; };
@@ -56,210 +65,334 @@ public:
   void SetStopRngRun (uint64_t run) { m_stopRngRun = run; };
   uint64_t GetStopRngRun () { return m_stopRngRun; };
   bool IsExternalRngRunControl () { return m_externalRngRunControl; };
+  uint32_t GetNWorkers () { return m_nWorkers; };
+  bool IsSweep () { return !m_sweepGrid.empty (); };
+  bool IsReplicationControl () { return m_ciTarget > 0; };
+  bool AddToReplicationControl (const RunSummary &srs); // true when the confidence interval targets are reached
+  uint32_t GetNReplications () { return m_replication.GetNRuns (); };
 
 private:
+  void ParseCommandLine (int argc, char **argv);
+  void ConfigureSweepPoint (uint32_t point); // program command line followed by the parameters of the grid point
+  std::vector<std::string> GetSettings (const std::set<std::string> &ignored); // command line arguments, except the ignored ones, sorted by name
+  void WriteSummaryHeader (std::ostream &out);
+  void WriteSummaryRow (std::ostream &out, uint64_t rngRun, const RunSummary &srs);
+  void WriteSummaryStatistics (std::ostream &out); // statistics of the runs in m_aggregator
+  void WriteSharedSummaryFile (const RunSummary &srs); // external rng run control: runs of concurrent program executions
+
   uint64_t m_startRngRun; // first RngRun
   uint64_t m_stopRngRun; // last RngRun
   uint64_t m_rngRun; // current value for RngRun
   bool m_externalRngRunControl; // internal or external control of rng run numbers
+  uint32_t m_nWorkers; // number of worker processes for parallel runs (0 = runs in this process, one by one)
   std::string m_csvFileNamePrefix; // file name for writing simulation summary results
+  std::string m_fileNamePrefix; // m_csvFileNamePrefix, with scenario parameters if it is the default "Net"
+  StatsRunAggregator m_aggregator; // statistics of all runs and E2E delay of all packets of all runs
+  std::vector<std::string> m_arguments; // program command line
+  std::string m_sweepGrid; // sweep grid declaration, e.g. "nNodes=60,120;nodeSpeed=1,5"
+  StatsSweep m_sweep;
+  std::string m_ciMetrics; // metrics for early stopping, e.g. "aap.throughput,aap.e2eDelayAverage"
+  double m_ciTarget; // target relative half-width of the confidence intervals (0 = run all rng runs)
+  double m_ciLevel; // confidence level
+  uint32_t m_minRuns; // minimum number of runs before the confidence intervals are checked
+  StatsReplicationControl m_replication;
+
+  // Scenario parameters
+  uint32_t m_nNodes; // number of nodes
+  uint32_t m_nSources; // number of source nodes for application traffic (number of sink nodes is the same in this example)
+  double m_simulationDuration; // in seconds
+  double m_netStartupTime; // [s] time before any application starts sending data
+  std::string m_rate; // application layer data rate
+  uint8_t m_appStartDiff; // [s] time difference between start of two following applications
+  std::string m_protocol; // protocol for transport layer
+  uint32_t m_packetSize; // Bytes
+  uint32_t m_port;
+  double m_txp; // dBm, transmission power
+  std::string m_phyMode; // physical data rate and modulation type
+  double m_nodeSpeed; // m/s
+  double m_nodePause; // s
+  double m_simAreaX; // m
+  double m_simAreaY; // m
+  bool m_compactHeader; // compact StatsHeader (about 10 B instead of 27 B)
+  bool m_bindFlows; // register flows at install time (implies compact StatsHeader)
+
+  // statistics of the current run, reused by all runs of this program execution; created by the
+  // first Run (), after the command line has selected the simulator implementation and scheduler
+  StatsFlows *m_stats;
 };
 
 
 RoutingExperiment::RoutingExperiment (uint64_t stopRun, std::string fn):
-    m_startRngRun (1), 
-    m_stopRngRun (stopRun),
-    m_rngRun (1),
-    m_externalRngRunControl (false), // default is internal control
-    m_csvFileNamePrefix (fn) // Default name is Net-Summary
+    RoutingExperiment (1, stopRun, fn)
 {
-	NS_ASSERT_MSG (m_startRngRun <= m_stopRngRun, "First run number must be less or equal to last.");
 }
 
 RoutingExperiment::RoutingExperiment (uint64_t startRun, uint64_t stopRun, std::string fn):
     m_startRngRun (startRun), // default is only one simulation run
     m_stopRngRun (stopRun),
     m_rngRun (startRun),
-	m_csvFileNamePrefix (fn) // Default name is Net-Summary
+    m_externalRngRunControl (false), // default is internal control
+    m_nWorkers (0),
+    m_csvFileNamePrefix (fn), // Default name is Net-Summary
+    m_ciMetrics ("aap.throughput,aap.e2eDelayAverage"),
+    m_ciTarget (0),
+    m_ciLevel (0.95),
+    m_minRuns (3),
+    m_nNodes (60),
+    m_nSources (3),
+    m_simulationDuration (200.0),
+    m_netStartupTime (10.0),
+    m_rate ("50kbps"),
+    m_appStartDiff (0),
+    m_protocol ("ns3::UdpSocketFactory"),
+    m_packetSize (128),
+    m_port (80),
+    m_txp (17),
+    m_phyMode ("DsssRate5_5Mbps"),
+    m_nodeSpeed (1.0),
+    m_nodePause (0.0),
+    m_simAreaX (2000.0),
+    m_simAreaY (2000.0),
+    m_compactHeader (false),
+    m_bindFlows (false),
+    m_stats (0)
 {
 	NS_ASSERT_MSG (m_startRngRun <= m_stopRngRun, "First run number must be less or equal to last.");
 }
+
+RoutingExperiment::~RoutingExperiment ()
+{
+  delete m_stats;
+}
+
+// Summary values in the summary file columns (every value: all flows avg, all packets avg)
+static const char *g_summaryColumns[] = {"throughput", "txPackets", "rxPackets", "lostPackets", "lostRatio",
+                                         "e2eDelayMin", "e2eDelayMax", "e2eDelayAverage", "e2eDelayMedianEstinate", "e2eDelayJitter",
+                                         "e2eDelayP90", "e2eDelayP95", "e2eDelayP99", "e2eDelayP999"};
+static const uint32_t g_nSummaryColumns = sizeof (g_summaryColumns) / sizeof (g_summaryColumns[0]);
+
+// Unit conversion of a summary file column (delays in ms)
+static double
+SummaryColumnScale (uint32_t column)
+{
+  return std::string (g_summaryColumns[column]).compare (0, 8, "e2eDelay") == 0 ? 1000.0 : 1.0;
+}
+
+// Statistics rows of the summary file: min, max, average, median, std. deviation, std. error, CI half-width
+static double
+RunStatistic (const StatsRunAggregator &aggregator, bool allFlows, uint32_t value, uint32_t row, double level)
+{
+  const StatsRunningStat &stat = aggregator.GetStat (allFlows, value);
+  switch (row)
+    {
+    case 0: return stat.GetMin ();
+    case 1: return stat.GetMax ();
+    case 2: return stat.GetMean ();
+    case 3: return aggregator.GetMedian (allFlows, value);
+    case 4: return stat.GetStdDev ();
+    case 5: return stat.GetCount () > 0 ? stat.GetStdDev () / std::sqrt ((double) stat.GetCount ()) : 0.0;
+    default: return stat.GetHalfWidth (level);
+    }
+}
+
 void
-RoutingExperiment::WriteToSummaryFile (RunSummary srs)
+RoutingExperiment::WriteSummaryHeader (std::ostream &out)
 {
-  std::ofstream out;
-  if (m_rngRun == m_startRngRun)
+  out << "Rng Run, Number of Flows, Throughput [bps],, Tx Packets,, Rx Packets,, Lost Packets,, Lost Ratio [%],, "
+      << "E2E Delay Min [ms],, E2E Delay Max [ms],, E2E Delay Average [ms],, E2E Delay Median Estimate [ms],, E2E Delay Jitter [ms],, "
+      << "E2E Delay 90th Percentile [ms],, E2E Delay 95th Percentile [ms],, E2E Delay 99th Percentile [ms],, E2E Delay 99.9th Percentile [ms],, "
+      << "Peak RSS [MB], End RSS [MB], Wall-clock Time [s], Simulated/Wall-clock Time, Simulator Events, Simulator Events per Second, "
+      << "Stats Callbacks, Time in Stats Callbacks [s]"
+      << std::endl;
+  out << ", ";
+  for (uint32_t col = 0; col < g_nSummaryColumns; ++col)
     {
-      out.open ((m_csvFileNamePrefix + "-Summary.csv").c_str (), std::ofstream::out | std::ofstream::trunc);
-      out << "Rng Run, Number of Flows, Throughput [bps],, Tx Packets,, Rx Packets,, Lost Packets,, Lost Ratio [%],, "
-          << "E2E Delay Min [ms],, E2E Delay Max [ms],, E2E Delay Average [ms],, E2E Delay Median Estimate [ms],, E2E Delay Jitter [ms]"
-          << std::endl;
-      out << ", , all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg"
-          << "  , all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg, all flows avg, all packets avg"
-          << std::endl;
+      out << ", all flows avg, all packets avg";
     }
-  else
+  out << ", run, after run" << std::endl;
+}
+
+void
+RoutingExperiment::WriteSummaryRow (std::ostream &out, uint64_t rngRun, const RunSummary &srs)
+{
+  out << rngRun << "," << srs.numberOfFlows;
+  for (uint32_t col = 0; col < g_nSummaryColumns; ++col)
     {
-      out.open ((m_csvFileNamePrefix + "-Summary.csv").c_str (), std::ofstream::out | std::ofstream::app);
+      uint32_t value = Summary::GetValueIndex (g_summaryColumns[col]);
+      out << "," << srs.aaf.GetValue (value) * SummaryColumnScale (col) << "," << srs.aap.GetValue (value) * SummaryColumnScale (col);
     }
-  out << m_rngRun << "," << srs.numberOfFlows << ","
-      << srs.aaf.throughput << "," << srs.aap.throughput << ","
-      << srs.aaf.txPackets << "," << srs.aap.txPackets << ","
-      << srs.aaf.rxPackets << "," << srs.aap.rxPackets << ","
-      << srs.aaf.lostPackets << "," << srs.aap.lostPackets << ","
-      << srs.aaf.lostRatio << ","<< srs.aap.lostRatio << ","
-      << srs.aaf.e2eDelayMin * 1000.0 << "," << srs.aap.e2eDelayMin * 1000.0 << ","
-      << srs.aaf.e2eDelayMax * 1000.0 << "," << srs.aap.e2eDelayMax * 1000.0 << ","
-      << srs.aaf.e2eDelayAverage * 1000.0 << "," << srs.aap.e2eDelayAverage * 1000.0 << ","
-      << srs.aaf.e2eDelayMedianEstinate * 1000.0 << "," << srs.aap.e2eDelayMedianEstinate * 1000.0 << ","
-      << srs.aaf.e2eDelayJitter * 1000.0 << "," << srs.aap.e2eDelayJitter * 1000.0
+  out << "," << srs.peakRss / 1048576.0 << "," << srs.endRss / 1048576.0
+      << "," << srs.performance.wallClockTime << "," << srs.performance.GetSimulatedOverWallClock ()
+      << "," << srs.performance.events << "," << srs.performance.GetEventsPerSecond ()
+      << "," << srs.performance.statsCallbacks << "," << srs.performance.statsCallbackTime
       << std::endl;
-  if (m_rngRun == m_stopRngRun)
+}
+
+void
+RoutingExperiment::WriteSummaryStatistics (std::ostream &out)
+{
+  // Statistics over all runs
+  const char *labels[] = {"Min", "Max", "Average", "Median", "Std. deviation", "Std. error"};
+  out << std::endl;
+  for (uint32_t row = 0; row < 7; ++row)
     {
+      if (row < 6)
+        {
+          out << "," << labels[row];
+        }
+      else
+        {
+          out << "," << m_ciLevel * 100 << "% CI half-width";
+        }
+      for (uint32_t col = 0; col < g_nSummaryColumns; ++col)
+        {
+          uint32_t value = Summary::GetValueIndex (g_summaryColumns[col]);
+          out << "," << RunStatistic (m_aggregator, true, value, row, m_ciLevel) * SummaryColumnScale (col)
+              << "," << RunStatistic (m_aggregator, false, value, row, m_ciLevel) * SummaryColumnScale (col);
+        }
       out << std::endl;
-      out << "," << "Min,"
-                    << "=MIN(C3:C" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(D3:D" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(E3:E" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(F3:F" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(G3:G" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(H3:H" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(I3:I" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(J3:J" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(K3:K" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(L3:L" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(M3:M" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(N3:N" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(O3:O" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(P3:P" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(Q3:Q" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(R3:R" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(S3:S" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(T3:T" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(U3:U" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MIN(V3:V" << m_stopRngRun - m_startRngRun + 3 << ")"
-                    << std::endl;
-      out << "," << "Max,"
-                    << "=MAX(C3:C" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(D3:D" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(E3:E" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(F3:F" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(G3:G" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(H3:H" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(I3:I" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(J3:J" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(K3:K" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(L3:L" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(M3:M" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(N3:N" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(O3:O" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(P3:P" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(Q3:Q" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(R3:R" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(S3:S" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(T3:T" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(U3:U" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MAX(V3:V" << m_stopRngRun - m_startRngRun + 3 << ")"
-                    << std::endl;
-      out << "," << "Average,"
-                    << "=AVERAGE(C3:C" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(D3:D" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(E3:E" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(F3:F" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(G3:G" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(H3:H" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(I3:I" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(J3:J" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(K3:K" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(L3:L" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(M3:M" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(N3:N" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(O3:O" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(P3:P" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(Q3:Q" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(R3:R" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(S3:S" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(T3:T" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(U3:U" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=AVERAGE(V3:V" << m_stopRngRun - m_startRngRun + 3 << ")"
-                    << std::endl;
-      out << "," << "Median,"
-                    << "=MEDIAN(C3:C" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(D3:D" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(E3:E" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(F3:F" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(G3:G" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(H3:H" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(I3:I" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(J3:J" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(K3:K" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(L3:L" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(M3:M" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(N3:N" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(O3:O" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(P3:P" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(Q3:Q" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(R3:R" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(S3:S" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(T3:T" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(U3:U" << m_stopRngRun - m_startRngRun + 3 << "),"
-                    << "=MEDIAN(V3:V" << m_stopRngRun - m_startRngRun + 3 << ")"
-                    << std::endl;
-      out << "," << "Std. deviation,"
-                    << "=STDEV(C3:C" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(D3:D" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(E3:E" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(F3:F" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(G3:G" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(H3:H" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(I3:I" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(J3:J" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(K3:K" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(L3:L" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(M3:M" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(N3:N" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(O3:O" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(P3:P" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(Q3:Q" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(R3:R" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(S3:S" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(T3:T" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(U3:U" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << "),"
-                    << "=STDEV(V3:V" << m_stopRngRun - m_startRngRun + 3 << ")/" << "SQRT(" << m_stopRngRun - m_startRngRun + 1 << ")"
-                    << std::endl;
     }
-  out.close ();
-};
 
-RunSummary
-RoutingExperiment::Run (int argc, char **argv)
+  // Exact percentiles of all packets of all runs
+  const StatsHist &pooledDelayHist = m_aggregator.GetDelayHist ();
+  out << std::endl;
+  out << ", All packets of all runs, Rx Packets, E2E Delay Average [ms], E2E Delay Jitter [ms], E2E Delay Median [ms], "
+      << "E2E Delay 90th Percentile [ms], E2E Delay 95th Percentile [ms], E2E Delay 99th Percentile [ms], E2E Delay 99.9th Percentile [ms]"
+      << std::endl;
+  out << ",," << pooledDelayHist.GetCount () << ","
+      << pooledDelayHist.GetMean () * 1000.0 << "," << pooledDelayHist.GetStdDev () * 1000.0 << ","
+      << pooledDelayHist.GetQuantile (0.5) * 1000.0 << "," << pooledDelayHist.GetQuantile (0.9) * 1000.0 << ","
+      << pooledDelayHist.GetQuantile (0.95) * 1000.0 << "," << pooledDelayHist.GetQuantile (0.99) * 1000.0 << ","
+      << pooledDelayHist.GetQuantile (0.999) * 1000.0
+      << std::endl;
+
+  // Confidence intervals of the early stopping metrics
+  if (IsReplicationControl ())
+    {
+      out << std::endl;
+      out << ", Metric (" << m_ciLevel * 100 << "% confidence), Runs, Mean, Half-width, Relative half-width (target " << m_ciTarget << ")" << std::endl;
+      std::ostringstream rows;
+      m_replication.WriteCsv (rows);
+      std::istringstream in (rows.str ());
+      std::string row;
+      while (std::getline (in, row))
+        {
+          out << "," << row << std::endl;
+        }
+    }
+}
+
+void
+RoutingExperiment::WriteSharedSummaryFile (const RunSummary &srs)
 {
-//  Packet::EnablePrinting ();
+  // The run is stored in its own shard file; the summary file is then rebuilt
+  // from the shards of all finished runs, so program executions can run concurrently
+  // and a crashed run is only missing from the summary file
+  // shards of a series with other settings (command line without the rng runs) are not used
+  std::set<std::string> ignored;
+  ignored.insert ("--currentRngRun");
+  ignored.insert ("--RngRun");
+  ignored.insert ("--startRngRun");
+  ignored.insert ("--stopRngRun");
+  ignored.insert ("--nWorkers");
+  std::vector<std::string> arguments = GetSettings (ignored);
+  std::string settings;
+  for (uint32_t i = 0; i < arguments.size (); ++i)
+    {
+      settings += (i == 0 ? "" : " ") + arguments[i];
+    }
+  StatsSummaryStore store (m_fileNamePrefix + "-Summary", settings);
+  NS_ABORT_MSG_UNLESS (store.Put (m_rngRun, srs), "Cannot write " << store.GetShardFileName (m_rngRun));
+
+  store.Lock ();
+  std::ostringstream out;
+  WriteSummaryHeader (out);
+  m_aggregator.Clear ();
+  for (uint64_t run = m_startRngRun; run <= m_stopRngRun; ++run)
+    {
+      RunSummary runSrs;
+      if (store.Get (run, runSrs))
+        {
+          m_aggregator.Add (run, runSrs);
+          WriteSummaryRow (out, run, runSrs);
+        }
+    }
+  out << std::endl << ",Finished runs," << m_aggregator.GetNRuns () << " of " << m_stopRngRun - m_startRngRun + 1 << std::endl;
+  WriteSummaryStatistics (out);
+  NS_ABORT_MSG_UNLESS (StatsSummaryStore::WriteFileAtomic (m_fileNamePrefix + "-Summary.csv", out.str ()),
+                       "Cannot write " << m_fileNamePrefix << "-Summary.csv");
+  store.Unlock ();
+}
 
-  uint32_t nNodes = 60; // number of nodes
-  uint32_t nSources = 3; // number of source nodes for application traffic (number of sink nodes is the same in this example)
+void
+RoutingExperiment::WriteToSummaryFile (RunSummary srs, bool firstRun, bool lastRun)
+{
+  if (m_externalRngRunControl)
+    {
+      WriteSharedSummaryFile (srs);
+      return;
+    }
 
-  double simulationDuration = 200.0; // in seconds
-  double netStartupTime = 10.0; // [s] time before any application starts sending data
+  std::ofstream out;
+  if (firstRun)
+    {
+      out.open ((m_fileNamePrefix + "-Summary.csv").c_str (), std::ofstream::out | std::ofstream::trunc);
+      m_aggregator.Clear ();
+      WriteSummaryHeader (out);
+    }
+  else
+    {
+      out.open ((m_fileNamePrefix + "-Summary.csv").c_str (), std::ofstream::out | std::ofstream::app);
+    }
+  m_aggregator.Add (m_rngRun, srs);
+  WriteSummaryRow (out, m_rngRun, srs);
+  if (lastRun)
+    {
+      WriteSummaryStatistics (out);
+    }
+  out.close ();
+};
 
-  std::string rate ("50kbps"); // application layer data rate
-  uint8_t appStartDiff = 0; // [s] time difference between start of two following applications
-  std::string protocol = "ns3::UdpSocketFactory"; // protocol for transport layer
-  uint32_t packetSize = 128; // Bytes
-  uint32_t port = 80;
+void
+RoutingExperiment::Configure (int argc, char **argv)
+{
+  m_arguments.assign (argv, argv + argc);
+  ParseCommandLine (argc, argv);
 
-  double txp = 17; // dBm, transmission power
-  std::string phyMode ("DsssRate5_5Mbps"); // physical data rate and modulation type
+  if (IsReplicationControl ())
+    {
+      NS_ABORT_MSG_IF (m_externalRngRunControl || IsSweep (), "--ciTarget needs internal rng run control and no sweep.");
+      NS_ABORT_MSG_UNLESS (m_replication.ParseMetrics (m_ciMetrics), "Not a valid list of metrics: " << m_ciMetrics);
+      m_replication.SetTarget (m_ciTarget, m_ciLevel);
+      m_replication.SetMinRuns (m_minRuns);
+    }
+}
 
-  double nodeSpeed = 1.0; // m/s
-  double nodePause = 0.0; // s
-  double simAreaX = 2000.0; // m
-  double simAreaY = 2000.0; // m
+bool
+RoutingExperiment::AddToReplicationControl (const RunSummary &srs)
+{
+  if (!IsReplicationControl ())
+    {
+      return false;
+    }
+  bool converged = m_replication.Add (srs);
+  std::ostringstream halfWidths;
+  for (uint32_t m = 0; m < m_replication.GetNMetrics (); ++m)
+    {
+      halfWidths << " " << m_replication.GetMetricName (m) << " " << m_replication.GetMetricStat (m).GetRelativeHalfWidth (m_ciLevel);
+    }
+  NS_LOG_UNCOND ("Runs: " << m_replication.GetNRuns () << ", relative half-widths:" << halfWidths.str ()
+                 << (converged ? " -> target reached" : ""));
+  return converged;
+}
 
+void
+RoutingExperiment::ParseCommandLine (int argc, char **argv)
+{
   CommandLine cmd;
   cmd.AddValue ("csvFileNamePrefix", "The name prefix of the CSV output file (without .csv extension)", m_csvFileNamePrefix);
-  cmd.AddValue ("nNodes", "Number of nodes in simulation", nNodes);
-  cmd.AddValue ("nSources", "Number of nodes that send data (max = nNodes/2)", nSources);
+  cmd.AddValue ("nNodes", "Number of nodes in simulation", m_nNodes);
+  cmd.AddValue ("nSources", "Number of nodes that send data (max = nNodes/2)", m_nSources);
   // User can set current rng run manualy (externaly) or authomaticaly
   cmd.AddValue ("externalRngRunControl", "Generation of 0=internal or 1=external current rng run number. If '1', then it must be used with --currentRngRun to externaly set current rng run number.", m_externalRngRunControl);
   // !!! Do not use this parameter if you enable authomatic control of current rng run !!!
@@ -268,38 +401,133 @@ RoutingExperiment::Run (int argc, char **argv)
   // If user want to externaly control rng runs this also must be set
   cmd.AddValue ("startRngRun", "Start number of RngRun. Used in both internal and external rng run generation.", m_startRngRun);
   cmd.AddValue ("stopRngRun", "End number of RngRun (must be greater then or equal to startRngNum). Used in both internal and external rng run generation.", m_stopRngRun);
-  cmd.AddValue ("simTime", "Duration of one simulation run.", simulationDuration);
-  cmd.AddValue ("width", "Width of simulation area (X-axis).", simAreaX);
-  cmd.AddValue ("height", "Height of simulation area (Y-axis).", simAreaY);
-  cmd.AddValue ("simTime", "Height of simulation area (Y-axis).", simulationDuration);
-  cmd.AddValue ("dataRate", "Application data rate.", rate);
-  cmd.AddValue ("packetSize", "Application test packet size.", packetSize);
-  cmd.AddValue ("nodeSpeed", "Application data rate.", nodeSpeed);
+  cmd.AddValue ("nWorkers", "Number of worker processes for parallel rng runs (internal rng run control only). 0 = all runs in this process, one by one (all cores for a sweep).", m_nWorkers);
+  cmd.AddValue ("sweep", "Parameter sweep grid, e.g. \"nNodes=60,120;nodeSpeed=1,5;dataRate=50kbps,100kbps\". Every point is run for all rng runs.", m_sweepGrid);
+  cmd.AddValue ("ciTarget", "Stop the rng runs when the relative half-width of the confidence interval of every --ciMetrics value is at most this (e.g. 0.05). 0 = run all rng runs. stopRngRun is the maximum.", m_ciTarget);
+  cmd.AddValue ("ciMetrics", "Comma separated metrics for --ciTarget: aap.<value> or aaf.<value> (all packets or all flows average), e.g. \"aap.throughput,aap.e2eDelayAverage\".", m_ciMetrics);
+  cmd.AddValue ("ciLevel", "Confidence level for --ciTarget.", m_ciLevel);
+  cmd.AddValue ("minRuns", "Minimum number of rng runs for --ciTarget.", m_minRuns);
+  cmd.AddValue ("simTime", "Duration of one simulation run.", m_simulationDuration);
+  cmd.AddValue ("width", "Width of simulation area (X-axis).", m_simAreaX);
+  cmd.AddValue ("height", "Height of simulation area (Y-axis).", m_simAreaY);
+  cmd.AddValue ("dataRate", "Application data rate.", m_rate);
+  cmd.AddValue ("packetSize", "Application test packet size.", m_packetSize);
+  cmd.AddValue ("nodeSpeed", "Maximum node speed [m/s].", m_nodeSpeed);
+  cmd.AddValue ("compactHeader", "Use compact StatsHeader in test packets.", m_compactHeader);
+  cmd.AddValue ("bindFlows", "Bind flows to StatsFlows slots at install time.", m_bindFlows);
   cmd.Parse (argc, argv);
 
-  // Should be placed after cmd.Parse () because user can overload rng run number with command line option "--currentRngRun"
-  RngSeedManager::SetRun (m_rngRun);
+  // with internal control the first run is startRngRun (--currentRngRun is ignored)
+  if (!m_externalRngRunControl)
+    {
+      m_rngRun = m_startRngRun;
+    }
 
   // File name
+  m_fileNamePrefix = m_csvFileNamePrefix;
   if (m_csvFileNamePrefix == "Net")
     {
-	    m_csvFileNamePrefix += "-area" + std::to_string (simAreaX) + "mx" + std::to_string (simAreaY) + "m"
-                        + "-nodes" + std::to_string (nSources) + "of" + std::to_string (nNodes)
-                        + "-speed" + std::to_string (nodeSpeed)
-                        + "-rate" + rate
-                        + "-packets" + std::to_string (packetSize) + "B";
+	    m_fileNamePrefix += "-area" + std::to_string (m_simAreaX) + "mx" + std::to_string (m_simAreaY) + "m"
+                        + "-nodes" + std::to_string (m_nSources) + "of" + std::to_string (m_nNodes)
+                        + "-speed" + std::to_string (m_nodeSpeed)
+                        + "-rate" + m_rate
+                        + "-packets" + std::to_string (m_packetSize) + "B";
     }
+}
+
+RunSummary
+RoutingExperiment::RunJob (uint32_t job)
+{
+  m_rngRun = m_startRngRun + job;
+  return Run ();
+}
+
+std::vector<std::string>
+RoutingExperiment::GetSettings (const std::set<std::string> &ignored)
+{
+  std::map<std::string, std::string> settings; // name -> the last argument with the name
+  for (uint32_t i = 1; i < m_arguments.size (); ++i)
+    {
+      std::string name = m_arguments[i].substr (0, m_arguments[i].find ('='));
+      if (ignored.find (name) == ignored.end ())
+        {
+          settings[name] = m_arguments[i];
+        }
+    }
+  std::vector<std::string> arguments;
+  for (std::map<std::string, std::string>::const_iterator it = settings.begin (); it != settings.end (); ++it)
+    {
+      arguments.push_back (it->second);
+    }
+  return arguments;
+}
+
+void
+RoutingExperiment::RunSweep ()
+{
+  NS_ABORT_MSG_UNLESS (m_sweep.ParseGrid (m_sweepGrid), "Not a valid sweep grid: " << m_sweepGrid);
+  m_sweep.SetRngRuns (m_startRngRun, m_stopRngRun);
+  ConfigureSweepPoint (0); // exits with the command line help if a swept parameter does not exist
+
+  // rows of the table are valid only for the same settings: the command line without
+  // the grid, the rng run range and the number of workers (they do not change the results)
+  std::set<std::string> ignored;
+  ignored.insert ("--sweep");
+  ignored.insert ("--startRngRun");
+  ignored.insert ("--stopRngRun");
+  ignored.insert ("--nWorkers");
+  m_sweep.SetSettings (GetSettings (ignored));
+
+  uint32_t nWorkers = m_nWorkers > 0 ? m_nWorkers : StatsRunPool::GetNCores ();
+  std::string tableFileName = m_csvFileNamePrefix + "-Sweep.csv";
+  uint32_t nCompleted = m_sweep.Run (tableFileName, nWorkers, MakeCallback (&RoutingExperiment::RunSweepJob, this));
+  NS_LOG_UNCOND ("Sweep points: " << m_sweep.GetNPoints () << ", rng runs per point: " << m_stopRngRun - m_startRngRun + 1
+                 << ", completed now: " << nCompleted << ", failed: " << m_sweep.GetNFailed ()
+                 << ", already in " << tableFileName << ": " << m_sweep.GetNSkipped ()
+                 << ", speedup: " << m_sweep.GetRunPool ().GetSpeedup ());
+}
+
+void
+RoutingExperiment::ConfigureSweepPoint (uint32_t point)
+{
+  // parameters of the grid point are parsed last, so they override the same parameters of the command line
+  std::vector<std::string> arguments = m_arguments;
+  std::vector<std::string> pointArguments = m_sweep.GetArguments (point);
+  arguments.insert (arguments.end (), pointArguments.begin (), pointArguments.end ());
+  std::vector<char *> argv;
+  for (uint32_t i = 0; i < arguments.size (); ++i)
+    {
+      argv.push_back (&arguments[i][0]);
+    }
+  ParseCommandLine (argv.size (), &argv[0]);
+}
+
+RunSummary
+RoutingExperiment::RunSweepJob (uint32_t point, uint64_t rngRun)
+{
+  ConfigureSweepPoint (point);
+  m_rngRun = rngRun;
+  return Run ();
+}
+
+RunSummary
+RoutingExperiment::Run ()
+{
+//  Packet::EnablePrinting ();
+
+  RngSeedManager::SetRun (m_rngRun);
+  StatsMemory::ResetPeakRss (); // peak RSS of this run only
 
   // Disable fragmentation for frames below 2200 bytes
   Config::SetDefault ("ns3::WifiRemoteStationManager::FragmentationThreshold", StringValue ("2200"));
   // Turn off RTS/CTS for frames below 2200 bytes
   Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue ("2200"));
   //Set Non-unicastMode rate to unicast mode
-  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode",StringValue (phyMode));
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode",StringValue (m_phyMode));
 
   // Creating nodes
   NodeContainer adhocNodes;
-  adhocNodes.Create (nNodes);
+  adhocNodes.Create (m_nNodes);
 
   // setting up wifi phy and channel using helpers
   WifiHelper wifi;
@@ -314,11 +542,11 @@ RoutingExperiment::Run (int argc, char **argv)
   // Add a mac and disable rate control
   WifiMacHelper wifiMac;
   wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
-                                "DataMode",StringValue (phyMode),
-                                "ControlMode",StringValue (phyMode));
+                                "DataMode",StringValue (m_phyMode),
+                                "ControlMode",StringValue (m_phyMode));
 
-  wifiPhy.Set ("TxPowerStart",DoubleValue (txp));
-  wifiPhy.Set ("TxPowerEnd", DoubleValue (txp));
+  wifiPhy.Set ("TxPowerStart",DoubleValue (m_txp));
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (m_txp));
 
   wifiMac.SetType ("ns3::AdhocWifiMac");
   NetDeviceContainer adhocDevices = wifi.Install (wifiPhy, wifiMac, adhocNodes);
@@ -328,9 +556,9 @@ RoutingExperiment::Run (int argc, char **argv)
 //  int64_t streamIndex = 0; // used to get consistent mobility across scenarios
 
   std::stringstream ssX;
-  ssX << "ns3::UniformRandomVariable[Min=0.0|Max=" << simAreaX << "]";
+  ssX << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_simAreaX << "]";
   std::stringstream ssY;
-  ssY << "ns3::UniformRandomVariable[Min=0.0|Max=" << simAreaY << "]";
+  ssY << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_simAreaY << "]";
   ObjectFactory pos;
   pos.SetTypeId ("ns3::RandomRectanglePositionAllocator");
   pos.Set ("X", StringValue (ssX.str ()));
@@ -340,9 +568,9 @@ RoutingExperiment::Run (int argc, char **argv)
 //  streamIndex += taPositionAlloc->AssignStreams (streamIndex);
 
   std::stringstream ssSpeed;
-  ssSpeed << "ns3::UniformRandomVariable[Min=0.0|Max=" << nodeSpeed << "]";
+  ssSpeed << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_nodeSpeed << "]";
   std::stringstream ssPause;
-  ssPause << "ns3::ConstantRandomVariable[Constant=" << nodePause << "]";
+  ssPause << "ns3::ConstantRandomVariable[Constant=" << m_nodePause << "]";
   mobilityAdhoc.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
                                   "Speed", StringValue (ssSpeed.str ()),
                                   "Pause", StringValue (ssPause.str ()),
@@ -374,32 +602,42 @@ RoutingExperiment::Run (int argc, char **argv)
 
   // Applications
   Ptr<UniformRandomVariable> var = CreateObject<UniformRandomVariable> ();
-  for (uint32_t i = 0; i<nSources; i++)
+  for (uint32_t i = 0; i<m_nSources; i++)
   {
     std::ostringstream oss;
     oss <<  "10.1.1." << i+1;
-    InetSocketAddress destinationAddress = InetSocketAddress (Ipv4Address (oss.str().c_str ()), port); // destination address for sorce apps
-    InetSocketAddress sinkReceivingAddress = InetSocketAddress (Ipv4Address::GetAny (), port); // sink nodes receive from any address
+    InetSocketAddress destinationAddress = InetSocketAddress (Ipv4Address (oss.str().c_str ()), m_port); // destination address for sorce apps
+    InetSocketAddress sinkReceivingAddress = InetSocketAddress (Ipv4Address::GetAny (), m_port); // sink nodes receive from any address
     double appJitter = var->GetValue (0.0,0.5); // half of a second jitter
    
     // Source
-    StatsSourceHelper sourceAppH (protocol, destinationAddress);
-    sourceAppH.SetConstantRate (DataRate (rate));
-    sourceAppH.SetAttribute ("PacketSize", UintegerValue(packetSize));
-    ApplicationContainer sourceApps = sourceAppH.Install (adhocNodes.Get (nNodes-1-i));
-    sourceApps.Start (Seconds (netStartupTime+i*appStartDiff+appJitter)); // Every app starts "appStartDiff" seconds after previous one
-    sourceApps.Stop (Seconds (netStartupTime+simulationDuration+appJitter)); // Every app stops after finishes runnig of "simulationDuration" seconds
+    StatsSourceHelper sourceAppH (m_protocol, destinationAddress);
+    sourceAppH.SetConstantRate (DataRate (m_rate));
+    sourceAppH.SetAttribute ("PacketSize", UintegerValue(m_packetSize));
+    sourceAppH.SetAttribute ("CompactHeader", BooleanValue (m_compactHeader));
+    sourceAppH.SetFlowBinding (m_bindFlows);
+    ApplicationContainer sourceApps = sourceAppH.Install (adhocNodes.Get (m_nNodes-1-i));
+    sourceApps.Start (Seconds (m_netStartupTime+i*m_appStartDiff+appJitter)); // Every app starts "m_appStartDiff" seconds after previous one
+    sourceApps.Stop (Seconds (m_netStartupTime+m_simulationDuration+appJitter)); // Every app stops after finishes runnig of "m_simulationDuration" seconds
    
     // Sink 
-    StatsSinkHelper sink (protocol, sinkReceivingAddress);
+    StatsSinkHelper sink (m_protocol, sinkReceivingAddress);
     ApplicationContainer sinkApps = sink.Install (adhocNodes.Get (i));
     sinkApps.Start (Seconds (0.0)); // start at the begining and wait for first packet
-    sinkApps.Stop (Seconds (netStartupTime+simulationDuration+1)); // stop a bit later then source to receive the last packet
+    sinkApps.Stop (Seconds (m_netStartupTime+m_simulationDuration+1)); // stop a bit later then source to receive the last packet
   }
  
   // Tracing
-  StatsFlows oneRunStats (m_rngRun, m_csvFileNamePrefix, true, false); // current RngRun, file name, RunSummary to file, EveryPacket to file
-  //StatsFlows oneRunStats (m_rngRun, m_csvFileNamePrefix); // current RngRun, file name, false, false
+  // StatsFlows is reused by all runs (flow storage keeps its capacity), StartRun connects it to the nodes of this run
+  if (m_stats == 0)
+    {
+      m_stats = new StatsFlows (m_rngRun, m_fileNamePrefix, true, false); // current RngRun, file name, RunSummary to file, EveryPacket to file
+    }
+  else
+    {
+      m_stats->StartRun (m_rngRun, m_fileNamePrefix); // current RngRun, file name
+    }
+  StatsFlows &oneRunStats = *m_stats;
   oneRunStats.SetHistResolution (0.0001); // sets resolution in seconds
 
   //sf.EnableWriteEvryRunSummary (); or sf.DisableWriteEvryRunSummary (); -> file: <m_csvFileNamePrefix>-Run<RngRun>.csv
@@ -407,18 +645,47 @@ RoutingExperiment::Run (int argc, char **argv)
 
   // Start-stop simulation
   // Stop event is set so that all applications have enough tie to finish 
-  Simulator::Stop (Seconds (netStartupTime+simulationDuration+1));
+  Simulator::Stop (Seconds (m_netStartupTime+m_simulationDuration+1));
   NS_LOG_INFO ("Current simulation run [" << m_startRngRun << "->" << m_stopRngRun << "]: " << m_rngRun);
   Simulator::Run ();
 
   // Write final statistics to file and return run summary
-  RunSummary srs = oneRunStats.Finalize ();
+  RunSummary srs = oneRunStats.Finalize (); // network results, performance and peak RSS of the run
 
-  // End of simulation
+  // End of simulation, everything of this run is released
   Simulator::Destroy ();
+  srs.endRss = StatsMemory::GetRss ();
+  NS_LOG_INFO ("Rng run " << m_rngRun << ": peak RSS " << srs.peakRss / 1048576.0 << " MB, RSS after the run " << srs.endRss / 1048576.0 << " MB");
   return srs;
 }
 
+//////////////////////////////////////////////
+// class ReplicationMonitor
+// adds results of parallel runs to the replication control in rng run order
+// (same runs as one by one) and stops the pool when the targets are reached
+//////////////////////////////////////////////
+class ReplicationMonitor
+{
+public:
+  ReplicationMonitor (RoutingExperiment *experiment, StatsRunPool *pool)
+    : m_experiment (experiment), m_pool (pool), m_nAdded (0) {};
+  void Result (uint32_t job, const RunSummary &srs)
+  {
+    // a failed run leaves a gap, so the targets are not checked after it
+    while (!m_pool->IsStopped () && m_nAdded < m_pool->GetNJobs () && m_pool->IsCompleted (m_nAdded))
+      {
+        if (m_experiment->AddToReplicationControl (m_pool->GetResult (m_nAdded++)))
+          {
+            m_pool->Stop ();
+          }
+      }
+  };
+
+private:
+  RoutingExperiment *m_experiment;
+  StatsRunPool *m_pool;
+  uint32_t m_nAdded; // runs 0 ... m_nAdded - 1 are added
+};
 
 //////////////////////////////////////////////
 // main function
@@ -429,15 +696,66 @@ int
 main (int argc, char *argv[])
 {
   RoutingExperiment experiment;
-  
+  experiment.Configure (argc, argv);
+
+  if (experiment.IsSweep ())
+    {
+      experiment.RunSweep ();
+      return 0;
+    }
+
+  if (experiment.GetNWorkers () > 0 && !experiment.IsExternalRngRunControl ())
+    {
+      // Parallel runs: every worker process takes the next rng run from the queue,
+      // summaries are written in rng run order when all runs are finished
+      uint64_t startRun = experiment.GetStartRngRun ();
+      uint32_t nRuns = experiment.GetStopRngRun () - startRun + 1;
+      StatsRunPool pool (experiment.GetNWorkers ());
+      ReplicationMonitor monitor (&experiment, &pool);
+      if (experiment.IsReplicationControl ())
+        {
+          pool.SetResultCallback (MakeCallback (&ReplicationMonitor::Result, &monitor));
+        }
+      pool.Run (nRuns, MakeCallback (&RoutingExperiment::RunJob, &experiment));
+      if (pool.IsStopped ())
+        {
+          // runs after the one that reached the targets are not used
+          nRuns = experiment.GetNReplications ();
+        }
+
+      bool firstRow = true;
+      uint32_t lastCompleted = 0;
+      for (uint32_t j = 0; j < nRuns; ++j)
+        {
+          lastCompleted = pool.IsCompleted (j) ? j : lastCompleted;
+        }
+      for (uint32_t j = 0; j < nRuns; ++j)
+        {
+          if (!pool.IsCompleted (j))
+            {
+              NS_LOG_UNCOND ("Rng run " << startRun + j << " failed, not written to the summary file");
+              continue;
+            }
+          experiment.SetRngRun (startRun + j);
+          experiment.WriteToSummaryFile (pool.GetResult (j), firstRow, j == lastCompleted); // -> file: <m_csvFileNamePrefix>-Summary.csv
+          firstRow = false;
+        }
+      NS_LOG_UNCOND ("Runs: " << nRuns << ", workers: " << pool.GetNWorkers () << " (" << StatsRunPool::GetNCores () << " cores)"
+                     << ", wall-clock time [s]: " << pool.GetWallClockTime ()
+                     << ", sum of run times [s]: " << pool.GetJobsTime ()
+                     << ", speedup: " << pool.GetSpeedup ());
+      return 0;
+    }
 
   // Run the same experiment several times for different RngRun numbers
   while (true)
     {
       // Run the experiment
-      // Also parse command line arguments if any (this includes rng run parameters)
-      RunSummary srs = experiment.Run (argc,argv);
-      experiment.WriteToSummaryFile (srs); // -> file: <m_csvFileNamePrefix>-Summary.csv
+      RunSummary srs = experiment.Run ();
+      bool converged = experiment.AddToReplicationControl (srs);
+      experiment.WriteToSummaryFile (srs, experiment.GetRngRun () == experiment.GetStartRngRun (),
+                                     converged || experiment.GetRngRun () == experiment.GetStopRngRun ()); // -> file: <m_csvFileNamePrefix>-Summary.csv
+      if (converged) break;
 
       // Control rng run
       if (experiment.IsExternalRngRunControl ()) break;
@@ -446,7 +764,3 @@ main (int argc, char *argv[])
     }
   return 0;
 }
-
-
-
-
@@ -0,0 +1,373 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Nenad Jevtic (n.jevtic@sf.bg.ac.rs), Marija Malnar (m.malnar@sf.bg.ac.rs)
+ */
+
+// Scaling ladder of the StatsFlows statistics layer: the same scenario is run
+// for a growing number of nodes and flows (by default 60/3, 500/500, 2000/5000
+// and 10000/50000) on cheap link models, and the cost of the stats layer is
+// reported as a percentage of the total simulation wall time at every step.
+//
+// Nodes are divided into segments that do not interact: pairs of nodes joined
+// by a point-to-point link, CSMA LANs, or Wi-Fi ad hoc cells with their own
+// channel. Every flow is one StatsPacketSource sending to the next node of its
+// segment (single hop, no routing), so the cost of the network model grows
+// linearly with the number of nodes and flows.
+//
+// Every step is run with StatsFlows and, unless --baseline=false, once more
+// without it (same RNG run, so the same events apart from the stats callbacks).
+// Two overhead values are given:
+//   Stats overhead [%]: StatsFlows construction (trace connection), time spent
+//     in the packet callbacks (RunPerformance::statsCallbackTime, sampled) and
+//     Finalize, over construction + Simulator::Run + Finalize
+//   Wall time difference [%]: the same total minus the wall time of the
+//     baseline run, over the total (includes the device Tx counters; noisy for
+//     short steps)
+//
+// Results are written to the CSV file after every step, so the finished steps
+// are kept when a large step runs out of memory.
+//
+// Usage: ./waf --run "stats-scaling --links=p2p,csma,wifi --nodes=60,500,2000,10000 --flows=3,500,5000,50000"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("stats-scaling");
+
+/////////////////////////////////////////////
+// Scenario parameters shared by all steps
+/////////////////////////////////////////////
+struct ScalingConfig
+{
+  uint32_t segmentSize; // nodes per CSMA LAN or Wi-Fi cell (point-to-point segments are node pairs)
+  uint32_t packetsPerFlow; // number of packets sent by every source application
+  uint32_t packetSize; // Bytes
+  std::string rate; // data rate of one source application
+  double startWindow; // [s] source applications start uniformly within this window
+  bool flowBinding; // install-time flow binding with the compact StatsHeader
+  bool scalarFile; // write the per-flow scalar file of every step
+};
+
+/////////////////////////////////////////////
+// Result of one ladder step
+/////////////////////////////////////////////
+struct StepResult
+{
+  StepResult () :
+    flows (0), txPackets (0), rxPackets (0), events (0), setupTime (0), runTime (0),
+    callbackTime (0), finalizeTime (0), statsCallbacks (0), peakRss (0)
+  {};
+
+  // construction + Simulator::Run + Finalize (only Simulator::Run without StatsFlows)
+  double GetTotalTime () const { return setupTime + runTime + finalizeTime; };
+  double GetStatsTime () const { return setupTime + callbackTime + finalizeTime; };
+
+  uint32_t flows;
+  uint64_t txPackets;
+  uint64_t rxPackets;
+  uint64_t events;
+  double setupTime; // [s] StatsFlows construction
+  double runTime; // [s] Simulator::Run
+  double callbackTime; // [s] StatsFlows packet callbacks (estimated)
+  double finalizeTime; // [s] StatsFlows::Finalize
+  uint64_t statsCallbacks;
+  uint64_t peakRss; // [B]
+};
+
+/**
+ * \param list comma separated list
+ * \return the list items
+ */
+std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream iss (list);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+/////////////////////////////////////////////
+// Build the nodes, links, addresses and applications of one step
+// Returns the simulation stop time [s]
+/////////////////////////////////////////////
+double
+BuildScenario (std::string link, uint32_t nNodes, uint32_t nFlows, const ScalingConfig &config)
+{
+  uint32_t segmentSize = (link == "p2p") ? 2 : config.segmentSize;
+  NS_ABORT_MSG_IF (segmentSize < 2 || segmentSize > 254, "Segment size must be between 2 and 254");
+  NS_ABORT_MSG_IF (nNodes % segmentSize != 0, "Number of nodes (" << nNodes << ") must be a multiple of the segment size (" << segmentSize << ")");
+  uint32_t port = 9;
+
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", link == "p2p" ? "255.255.255.252" : "255.255.255.0");
+  std::vector<Ipv4Address> nodeAddress (nNodes);
+
+  // link layer of every segment
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  csma.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (5)));
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate24Mbps"),
+                                "ControlMode", StringValue ("OfdmRate6Mbps"));
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  WifiMacHelper wifiMac;
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+
+  for (uint32_t base = 0; base < nNodes; base += segmentSize)
+    {
+      NodeContainer segment;
+      for (uint32_t i = base; i < base + segmentSize; ++i)
+        {
+          segment.Add (nodes.Get (i));
+        }
+      NetDeviceContainer devices;
+      if (link == "p2p")
+        {
+          devices = p2p.Install (segment);
+        }
+      else if (link == "csma")
+        {
+          devices = csma.Install (segment); // every call creates a new LAN
+        }
+      else
+        {
+          wifiPhy.SetChannel (wifiChannel.Create ()); // every cell has its own channel
+          devices = wifi.Install (wifiPhy, wifiMac, segment);
+        }
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      address.NewNetwork ();
+      for (uint32_t i = 0; i < segmentSize; ++i)
+        {
+          nodeAddress[base + i] = interfaces.GetAddress (i);
+        }
+    }
+
+  if (link == "wifi")
+    {
+      // nodes of a cell are in a row 1 m apart, rows (cells) are 1 km apart
+      MobilityHelper mobility;
+      mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                     "MinX", DoubleValue (0.0), "MinY", DoubleValue (0.0),
+                                     "DeltaX", DoubleValue (1.0), "DeltaY", DoubleValue (1000.0),
+                                     "GridWidth", UintegerValue (segmentSize),
+                                     "LayoutType", StringValue ("RowFirst"));
+      mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+      mobility.Install (nodes);
+    }
+
+  // One sink on every node receives all flows sent to the node
+  StatsSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApps = sink.Install (nodes);
+  sinkApps.Start (Seconds (0.0));
+
+  // Flow f is sent by node f % nNodes to the next node of its segment
+  double flowDuration = config.packetsPerFlow * config.packetSize * 8.0 / DataRate (config.rate).GetBitRate ();
+  Ptr<UniformRandomVariable> var = CreateObject<UniformRandomVariable> ();
+  for (uint32_t f = 0; f < nFlows; ++f)
+    {
+      uint32_t source = f % nNodes;
+      uint32_t base = source - source % segmentSize;
+      uint32_t destination = base + (source - base + 1) % segmentSize;
+      StatsSourceHelper sourceAppH ("ns3::UdpSocketFactory", InetSocketAddress (nodeAddress[destination], port));
+      sourceAppH.SetConstantRate (DataRate (config.rate), config.packetSize);
+      sourceAppH.SetAttribute ("MaxBytes", UintegerValue (config.packetsPerFlow * config.packetSize));
+      sourceAppH.SetFlowBinding (config.flowBinding);
+      ApplicationContainer sourceApps = sourceAppH.Install (nodes.Get (source));
+      sourceApps.Start (Seconds (1.0 + var->GetValue (0.0, config.startWindow)));
+      sourceApps.Stop (Seconds (2.0 + config.startWindow + flowDuration));
+    }
+  double stopTime = 3.0 + config.startWindow + flowDuration;
+  sinkApps.Stop (Seconds (stopTime));
+  return stopTime;
+}
+
+/////////////////////////////////////////////
+// Run one step, with or without StatsFlows
+/////////////////////////////////////////////
+StepResult
+RunStep (std::string link, uint32_t nNodes, uint32_t nFlows, const ScalingConfig &config, bool withStats)
+{
+  StatsMemory::ResetPeakRss (); // peak RSS of this step only
+  double stopTime = BuildScenario (link, nNodes, nFlows, config);
+  StepResult result;
+  Simulator::Stop (Seconds (stopTime));
+
+  StatsFlows *stats = 0;
+  if (withStats)
+    {
+      std::ostringstream fileName;
+      fileName << "Scaling-" << link << "-nodes" << nNodes << "-flows" << nFlows;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      stats = new StatsFlows (RngSeedManager::GetRun (), fileName.str (), config.scalarFile, false);
+      result.setupTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+      Simulator::Run ();
+
+      start = std::chrono::steady_clock::now ();
+      RunSummary srs = stats->Finalize ();
+      result.finalizeTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+      result.runTime = srs.performance.wallClockTime;
+      result.callbackTime = srs.performance.statsCallbackTime;
+      result.statsCallbacks = srs.performance.statsCallbacks;
+      result.events = srs.performance.events;
+      result.flows = srs.numberOfFlows;
+      result.txPackets = srs.aap.txPackets;
+      result.rxPackets = srs.aap.rxPackets;
+    }
+  else
+    {
+      uint64_t eventsStart = Simulator::GetEventCount ();
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      Simulator::Run ();
+      result.runTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+      result.events = Simulator::GetEventCount () - eventsStart;
+    }
+  result.peakRss = StatsMemory::GetPeakRss ();
+
+  Simulator::Destroy ();
+  delete stats; // after Simulator::Destroy, the trace sources are gone
+  // the next step assigns the same addresses again (the StatsHeader flow registry is cleared by Simulator::Destroy)
+  Ipv4AddressGenerator::Reset ();
+  return result;
+}
+
+int
+main (int argc, char **argv)
+{
+  std::string links = "p2p,csma,wifi";
+  std::string nodesList = "60,500,2000,10000";
+  std::string flowsList = "3,500,5000,50000";
+  bool baseline = true;
+  std::string outputFile = "stats-scaling.csv";
+
+  ScalingConfig config;
+  config.segmentSize = 20;
+  config.packetsPerFlow = 20;
+  config.packetSize = 128;
+  config.rate = "16kbps";
+  config.startWindow = 10.0;
+  config.flowBinding = false;
+  config.scalarFile = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("links", "Comma separated link models: p2p, csma, wifi.", links);
+  cmd.AddValue ("nodes", "Comma separated number of nodes of every ladder step.", nodesList);
+  cmd.AddValue ("flows", "Comma separated number of flows of every ladder step.", flowsList);
+  cmd.AddValue ("baseline", "Run every step also without StatsFlows.", baseline);
+  cmd.AddValue ("segmentSize", "Nodes per CSMA LAN or Wi-Fi cell.", config.segmentSize);
+  cmd.AddValue ("packetsPerFlow", "Number of packets sent in every flow.", config.packetsPerFlow);
+  cmd.AddValue ("packetSize", "Application test packet size.", config.packetSize);
+  cmd.AddValue ("dataRate", "Data rate of one source application.", config.rate);
+  cmd.AddValue ("startWindow", "Source applications start uniformly within this time window [s].", config.startWindow);
+  cmd.AddValue ("flowBinding", "Bind flows at install time (compact StatsHeader).", config.flowBinding);
+  cmd.AddValue ("scalarFile", "Write the scalar file with per flow results of every step.", config.scalarFile);
+  cmd.AddValue ("output", "CSV file with the results of all steps.", outputFile);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> linkModels = SplitList (links);
+  std::vector<std::string> nodes = SplitList (nodesList);
+  std::vector<std::string> flows = SplitList (flowsList);
+  NS_ABORT_MSG_IF (nodes.size () != flows.size (), "--nodes and --flows must have the same number of steps");
+  for (uint32_t l = 0; l < linkModels.size (); ++l)
+    {
+      NS_ABORT_MSG_IF (linkModels[l] != "p2p" && linkModels[l] != "csma" && linkModels[l] != "wifi",
+                       "Unknown link model " << linkModels[l]);
+    }
+
+  std::ofstream out (outputFile.c_str ());
+  NS_ABORT_MSG_IF (!out.is_open (), "Cannot open " << outputFile);
+  std::ostringstream header;
+  header << "Link, Nodes, Flows, Tx Packets, Rx Packets, Events, Stats Callbacks, "
+         << "StatsFlows Setup [s], Simulator Run [s], Stats Callbacks [s], Finalize [s], Total [s], Stats Overhead [%], "
+         << "Baseline Run [s], Wall Time Difference [%], Peak RSS [MB], Baseline Peak RSS [MB]";
+  out << header.str () << std::endl;
+  std::cout << header.str () << std::endl;
+
+  for (uint32_t l = 0; l < linkModels.size (); ++l)
+    {
+      for (uint32_t s = 0; s < nodes.size (); ++s)
+        {
+          uint32_t nNodes = std::stoul (nodes[s]);
+          uint32_t nFlows = std::stoul (flows[s]);
+          StepResult result = RunStep (linkModels[l], nNodes, nFlows, config, true);
+          StepResult base;
+          if (baseline)
+            {
+              base = RunStep (linkModels[l], nNodes, nFlows, config, false);
+            }
+
+          std::ostringstream row;
+          row << linkModels[l] << ", " << nNodes << ", " << result.flows << ", " << result.txPackets << ", "
+              << result.rxPackets << ", " << result.events << ", " << result.statsCallbacks << ", "
+              << result.setupTime << ", " << result.runTime << ", " << result.callbackTime << ", "
+              << result.finalizeTime << ", " << result.GetTotalTime () << ", "
+              << 100.0 * result.GetStatsTime () / result.GetTotalTime () << ", ";
+          if (baseline)
+            {
+              row << base.runTime << ", " << 100.0 * (result.GetTotalTime () - base.runTime) / result.GetTotalTime () << ", ";
+            }
+          else
+            {
+              row << ", , ";
+            }
+          row << result.peakRss / 1048576.0 << ", ";
+          if (baseline)
+            {
+              row << base.peakRss / 1048576.0;
+            }
+          out << row.str () << std::endl; // flushed after every step
+          std::cout << row.str () << std::endl;
+        }
+    }
+  out.close ();
+  return 0;
+}
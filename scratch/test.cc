@@ -215,6 +215,7 @@ main (int argc, char **argv)
   NS_LOG_UNCOND ("E2E Delay Average [ms]: AAF " << srs.aaf.e2eDelayAverage * 1000.0 << ", AAP " << srs.aap.e2eDelayAverage * 1000.0);
   NS_LOG_UNCOND ("E2E Delay Median Estimate [ms]: AAF " << srs.aaf.e2eDelayMedianEstinate * 1000.0 << ", AAP " << srs.aap.e2eDelayMedianEstinate * 1000.0);
   NS_LOG_UNCOND ("E2E Delay Jitter [ms]: AAF " << srs.aaf.e2eDelayJitter * 1000.0 << ", AAP " << srs.aap.e2eDelayJitter * 1000.0);
+  NS_LOG_UNCOND ("E2E Delay 99th Percentile [ms]: AAF " << srs.aaf.e2eDelayP99 * 1000.0 << ", AAP " << srs.aap.e2eDelayP99 * 1000.0);
 
   // End of simulation
   Simulator::Destroy ();
@@ -0,0 +1,64 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Nenad Jevtic (n.jevtic@sf.bg.ac.rs), Marija Malnar (m.malnar@sf.bg.ac.rs)
+ */
+
+// Converts binary vector file (written by StatsFlows with StatsVectorFile::BINARY format)
+// to the CSV vector file layout.
+//
+// Usage: ./waf --run "vec-to-csv --input=Net-Run_1-vec.bin --output=Net-Run_1-vec.csv"
+
+#include <iostream>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "Binary vector file (<prefix>-Run_<n>-vec.bin).", input);
+  cmd.AddValue ("output", "Output CSV file. Default is the input file name with .csv extension.", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Input file is not set (--input=<file>)." << std::endl;
+      return 1;
+    }
+  if (output.empty ())
+    {
+      std::string::size_type dot = input.rfind (".bin");
+      output = (dot == std::string::npos ? input : input.substr (0, dot)) + ".csv";
+    }
+
+  int64_t n = StatsVectorFile::ConvertToCsv (input, output);
+  if (n < 0)
+    {
+      std::cerr << "Not a valid binary vector file: " << input << std::endl;
+      return 1;
+    }
+  std::cout << n << " records written to " << output << std::endl;
+  return 0;
+}
@@ -0,0 +1,890 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+// Microbenchmarks of the stats layer components, each measured in isolation
+// (no network model). Every measurement is one line of machine-readable output,
+// CSV or JSON lines, with the median and minimum cost per operation over
+// several repeats (the first, warm-up repeat is not counted). Results of
+// different builds can be appended to one file and compared over time:
+//
+//   ./waf --run "stats-microbenchmark --output=stats-bench.csv --label=$(git rev-parse --short HEAD)"
+//
+// Some benchmarks also give the memory of the measured object (bytes) and the
+// largest relative error of an approximation (errorPercent), e.g. of histogram
+// quantiles; the columns are empty for the others.
+//
+// The program is built with the applications module tests (./waf configure --enable-tests).
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <ctime>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("StatsMicrobenchmark");
+
+namespace {
+
+/**
+ * \brief Repeats a measurement and writes its result line.
+ *
+ * Usage:
+ * \code
+ *   for (report.Start ("HistAddValue", "uniform/fixed", nValues, nValues); report.Repeat (); )
+ *     {
+ *       // nValues operations
+ *     }
+ * \endcode
+ */
+class BenchmarkReport
+{
+public:
+  BenchmarkReport (std::ostream &out, bool json, std::string label, std::string filter, uint32_t repeats, double scale)
+    : m_out (out),
+      m_json (json),
+      m_label (label),
+      m_filter (filter),
+      m_repeats (std::max<uint32_t> (repeats, 1)),
+      m_scale (scale),
+      m_time (std::time (0)),
+      m_running (false),
+      m_warmUp (true),
+      m_parameter (0),
+      m_iterations (1),
+      m_bytes (-1),
+      m_error (-1)
+  {};
+
+  /// \return true if the benchmark is selected by the filter (substring of the name)
+  bool IsSelected (std::string benchmark) const
+  {
+    return m_filter.empty () || benchmark.find (m_filter) != std::string::npos;
+  };
+  /// \return number of operations scaled by the --scale option, at least one
+  uint32_t Scale (uint32_t iterations) const
+  {
+    return std::max<uint32_t> (1, (uint32_t)(iterations * m_scale));
+  };
+  void WriteHeader ()
+  {
+    if (!m_json)
+      {
+        m_out << "label,time,benchmark,variant,parameter,iterations,repeats,nsPerOp,nsPerOpMin,opsPerSecond,bytes,errorPercent" << std::endl;
+      }
+  };
+
+  /**
+   * \brief Start a measurement
+   * \param benchmark the benchmark (component and method)
+   * \param variant the variant (e.g. value distribution or address type)
+   * \param parameter the size of the measured object (values, bins, flows)
+   * \param iterations the number of operations in every repeat
+   */
+  void Start (std::string benchmark, std::string variant, uint64_t parameter, uint32_t iterations)
+  {
+    m_benchmark = benchmark;
+    m_variant = variant;
+    m_parameter = parameter;
+    m_iterations = iterations;
+    m_samples.clear ();
+    m_running = false;
+    m_warmUp = true;
+  };
+  /**
+   * \brief Size of the measured object (memory or file), written with the result
+   * of the current (or the next) measurement
+   * \param bytes size in bytes
+   */
+  void SetBytes (double bytes) { m_bytes = bytes; };
+  /**
+   * \brief Largest relative error of the measured approximation, written with the
+   * result of the current (or the next) measurement
+   * \param error relative error [%]
+   */
+  void SetError (double error) { m_error = error; };
+  /**
+   * \brief Close the previous repeat and open the next one
+   * \return false after the last repeat (the result is then written)
+   */
+  bool Repeat ()
+  {
+    if (m_running)
+      {
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now ();
+        if (!m_warmUp)
+          {
+            m_samples.push_back (std::chrono::duration<double, std::nano> (stop - m_start).count () / m_iterations);
+          }
+        m_warmUp = false;
+      }
+    if (m_samples.size () == m_repeats)
+      {
+        m_running = false;
+        Write ();
+        return false;
+      }
+    m_running = true;
+    m_start = std::chrono::steady_clock::now ();
+    return true;
+  };
+
+private:
+  void Write ()
+  {
+    std::sort (m_samples.begin (), m_samples.end ());
+    double median = m_samples.size () % 2 ? m_samples[m_samples.size () / 2]
+      : 0.5 * (m_samples[m_samples.size () / 2 - 1] + m_samples[m_samples.size () / 2]);
+    double opsPerSecond = median > 0 ? 1e9 / median : 0;
+    if (m_json)
+      {
+        m_out << "{\"label\":\"" << m_label << "\",\"time\":" << m_time
+              << ",\"benchmark\":\"" << m_benchmark << "\",\"variant\":\"" << m_variant
+              << "\",\"parameter\":" << m_parameter << ",\"iterations\":" << m_iterations
+              << ",\"repeats\":" << m_repeats << ",\"nsPerOp\":" << median
+              << ",\"nsPerOpMin\":" << m_samples[0] << ",\"opsPerSecond\":" << opsPerSecond;
+        if (m_bytes >= 0)
+          {
+            m_out << ",\"bytes\":" << m_bytes;
+          }
+        if (m_error >= 0)
+          {
+            m_out << ",\"errorPercent\":" << m_error;
+          }
+        m_out << "}" << std::endl;
+      }
+    else
+      {
+        m_out << m_label << "," << m_time << "," << m_benchmark << "," << m_variant << ","
+              << m_parameter << "," << m_iterations << "," << m_repeats << ","
+              << median << "," << m_samples[0] << "," << opsPerSecond << ",";
+        if (m_bytes >= 0)
+          {
+            m_out << m_bytes;
+          }
+        m_out << ",";
+        if (m_error >= 0)
+          {
+            m_out << m_error;
+          }
+        m_out << std::endl;
+      }
+    m_bytes = -1;
+    m_error = -1;
+  };
+
+  std::ostream &m_out;
+  bool m_json;
+  std::string m_label;
+  std::string m_filter;
+  uint32_t m_repeats;
+  double m_scale;
+  std::time_t m_time;         //!< Start of the program, the same for all lines
+  bool m_running;
+  bool m_warmUp;
+  std::chrono::steady_clock::time_point m_start;
+  std::string m_benchmark;
+  std::string m_variant;
+  uint64_t m_parameter;
+  uint32_t m_iterations;
+  std::vector<double> m_samples; //!< ns per operation of every repeat
+  double m_bytes;                //!< Memory of the measured object, -1 if not given
+  double m_error;                //!< Relative error [%], -1 if not given
+};
+
+volatile double g_sink = 0; //!< Results of the measured calls, so they are not optimized away
+
+/**
+ * \param hist the histogram
+ * \param bins number of fixed width bins to fill
+ */
+void
+FillHist (StatsHist &hist, uint32_t bins)
+{
+  Ptr<UniformRandomVariable> var = CreateObject<UniformRandomVariable> ();
+  for (uint32_t v = 0; v < 10 * bins; ++v)
+    {
+      hist.AddValue (var->GetValue (0.0, bins * 0.0001));
+    }
+}
+
+/**
+ * \brief Vector file record written as by the previous writer (VectorData),
+ * which opened, appended to and closed the file for every record
+ * \param fileName the file name
+ * \param rxTime packet reception time
+ * \param flowIndex flow index
+ * \param seqNo packet sequence number
+ * \param delay packet delay
+ */
+void
+WriteRecordPerOpen (std::string fileName, Time rxTime, uint32_t flowIndex, uint32_t seqNo, Time delay)
+{
+  std::ofstream out;
+  out.open (fileName.c_str (), std::ofstream::out | std::ofstream::app);
+  out << flowIndex << "," << rxTime.GetDouble () / 1000.0 << "," << seqNo << ",";
+  for (uint32_t i = 0; i < flowIndex; ++i)
+    {
+      out << ",";
+    }
+  out << delay.GetDouble () / 1000.0 << std::endl;
+  out.close ();
+}
+
+uint64_t g_contextTxBytes = 0;
+
+/// Device Tx callback with the context string (Config::Connect)
+void
+ContextTx (std::string context, Ptr<const Packet> packet)
+{
+  g_contextTxBytes += packet->GetSize ();
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////
+// StatsHist::AddValue: cost per value for delay-like value distributions and
+// for the histogram layouts. Bins are allocated during the warm-up repeat,
+// so the steady-state cost is measured.
+/////////////////////////////////////////////
+void
+BenchmarkHistAddValue (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("HistAddValue"))
+    {
+      return;
+    }
+  const uint32_t nValues = 1 << 20; // power of two, values are indexed with a mask
+  uint32_t iterations = report.Scale (nValues);
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+  Ptr<LogNormalRandomVariable> logNormal = CreateObject<LogNormalRandomVariable> ();
+  const char *distributions[] = {"constant", "uniform", "exponential", "lognormal-outliers"};
+  const char *layouts[] = {"fixed", "sparse-fixed", "log-linear"};
+  std::vector<double> values (nValues);
+
+  for (uint32_t d = 0; d < 4; ++d)
+    {
+      for (uint32_t v = 0; v < nValues; ++v)
+        {
+          switch (d)
+            {
+            case 0: values[v] = 0.002; break;
+            case 1: values[v] = uniform->GetValue (0.0, 0.1); break;
+            case 2: values[v] = exponential->GetValue (0.005, 0); break;
+            default:
+              // median 2 ms, one value in 10000 is a 1-60 s stall
+              values[v] = (uniform->GetValue () < 0.0001) ? uniform->GetValue (1.0, 60.0) : logNormal->GetValue (std::log (0.002), 1.5);
+            }
+        }
+      for (uint32_t l = 0; l < 3; ++l)
+        {
+          StatsHist hist (l < 2 ? 0.0001 : 0.000001);
+          hist.SetSparse (l == 1);
+          hist.SetLogLinear (l == 2 ? 7 : 0);
+          std::string variant = std::string (distributions[d]) + "/" + layouts[l];
+          for (report.Start ("HistAddValue", variant, nValues, iterations); report.Repeat (); )
+            {
+              for (uint32_t i = 0; i < iterations; ++i)
+                {
+                  hist.AddValue (values[i & (nValues - 1)]);
+                }
+            }
+          g_sink = g_sink + hist.GetCount ();
+        }
+    }
+}
+
+/////////////////////////////////////////////
+// StatsHist::GetMedianEstimation on large histograms (dense and sparse storage)
+/////////////////////////////////////////////
+void
+BenchmarkHistMedian (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("HistMedian"))
+    {
+      return;
+    }
+  uint32_t bins[] = {10000, 100000, 1000000};
+  for (uint32_t b = 0; b < 3; ++b)
+    {
+      for (uint32_t sparse = 0; sparse < 2; ++sparse)
+        {
+          StatsHist hist (0.0001);
+          hist.SetSparse (sparse);
+          FillHist (hist, bins[b]);
+          uint32_t iterations = report.Scale (10000000 / bins[b]);
+          for (report.Start ("HistMedian", sparse ? "sparse" : "dense", hist.GetNBins (), iterations); report.Repeat (); )
+            {
+              for (uint32_t i = 0; i < iterations; ++i)
+                {
+                  g_sink = g_sink + hist.GetMedianEstimation ();
+                }
+            }
+        }
+    }
+}
+
+/////////////////////////////////////////////
+// StatsHist::GetQuantile on large histograms: building the cumulative index
+// (after every new value) and queries on a built index
+/////////////////////////////////////////////
+void
+BenchmarkHistQuantile (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("HistQuantile"))
+    {
+      return;
+    }
+  uint32_t bins[] = {10000, 100000, 1000000};
+  double q[] = {0.5, 0.9, 0.95, 0.99, 0.999};
+  for (uint32_t b = 0; b < 3; ++b)
+    {
+      StatsHist hist (0.0001);
+      FillHist (hist, bins[b]);
+      uint32_t iterations = report.Scale (10000000 / bins[b]);
+      for (report.Start ("HistQuantile", "index-build", hist.GetNBins (), iterations); report.Repeat (); )
+        {
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              hist.AddValue (0.0); // the index is rebuilt when the count changes
+              g_sink = g_sink + hist.GetQuantile (0.5);
+            }
+        }
+      iterations = report.Scale (1000000);
+      for (report.Start ("HistQuantile", "query", hist.GetNBins (), iterations); report.Repeat (); )
+        {
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              g_sink = g_sink + hist.GetQuantile (q[i % 5]);
+            }
+        }
+    }
+}
+
+/////////////////////////////////////////////
+// StatsHist::Merge: pooling 1000 per-flow delay histograms into one,
+// fixed width and log-linear layout
+/////////////////////////////////////////////
+void
+BenchmarkHistMerge (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("HistMerge"))
+    {
+      return;
+    }
+  const uint32_t nFlows = 1000;
+  Ptr<LogNormalRandomVariable> delay = CreateObject<LogNormalRandomVariable> ();
+  for (uint32_t logLinear = 0; logLinear < 2; ++logLinear)
+    {
+      std::vector<StatsHist> flows (nFlows, StatsHist (logLinear ? 0.000001 : 0.0001));
+      for (uint32_t f = 0; f < nFlows; ++f)
+        {
+          flows[f].SetLogLinear (logLinear ? 7 : 0);
+          for (uint32_t v = 0; v < 1000; ++v)
+            {
+              flows[f].AddValue (delay->GetValue (std::log (0.002), 1.0));
+            }
+        }
+      uint32_t iterations = report.Scale (nFlows);
+      for (report.Start ("HistMerge", logLinear ? "log-linear" : "fixed", nFlows, iterations); report.Repeat (); )
+        {
+          StatsHist pooled;
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              pooled.Merge (flows[i % nFlows]);
+            }
+          report.SetBytes (pooled.GetMemoryUsage ());
+          g_sink = g_sink + pooled.GetCount ();
+        }
+    }
+}
+
+/////////////////////////////////////////////
+// Per-flow delay histograms of a large run: cost per value of filling one
+// histogram per flow and taking its median and 99th percentile (as in
+// FlowData::Finalize), memory per flow and the largest relative error of the
+// 50th, 99th and 99.9th percentiles, for the dense and sparse storage of both
+// layouts. "heavy-tail": median 2 ms with rare 1-60 s stalls (20 flows);
+// "route-repair": tens of ms, 1 % of the packets delayed 0.5-5 s (10000 flows
+// of a multi-hop run, 200 packets per flow)
+/////////////////////////////////////////////
+void
+BenchmarkHistFlows (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("HistFlows"))
+    {
+      return;
+    }
+  Ptr<LogNormalRandomVariable> delay = CreateObject<LogNormalRandomVariable> ();
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  const char *distributions[] = {"heavy-tail", "route-repair"};
+  const char *layouts[] = {"dense-fixed", "sparse-fixed", "dense-log-linear", "sparse-log-linear"};
+  uint32_t nFlows[] = {20, 10000};
+  uint32_t nValues[] = {10000, 200};
+  double q[] = {0.5, 0.99, 0.999};
+
+  for (uint32_t d = 0; d < 2; ++d)
+    {
+      uint32_t flows = report.Scale (nFlows[d]);
+      std::vector<std::vector<double> > values (flows, std::vector<double> (nValues[d]));
+      for (uint32_t f = 0; f < flows; ++f)
+        {
+          for (uint32_t v = 0; v < nValues[d]; ++v)
+            {
+              values[f][v] = d == 0
+                ? ((uniform->GetValue () < 0.0001) ? uniform->GetValue (1.0, 60.0) : delay->GetValue (std::log (0.002), 1.5))
+                : ((uniform->GetValue () < 0.01) ? uniform->GetValue (0.5, 5.0) : delay->GetValue (std::log (0.02), 0.7));
+            }
+        }
+      for (uint32_t l = 0; l < 4; ++l)
+        {
+          // memory and accuracy, outside of the measurement
+          double bytes = 0;
+          double maxError = 0;
+          for (uint32_t f = 0; f < flows; ++f)
+            {
+              StatsHist hist (l < 2 ? 0.0001 : 0.000001);
+              hist.SetLogLinear (l < 2 ? 0 : 7);
+              hist.SetSparse (l % 2 == 1);
+              for (uint32_t v = 0; v < nValues[d]; ++v)
+                {
+                  hist.AddValue (values[f][v]);
+                }
+              bytes += hist.GetMemoryUsage ();
+              std::vector<double> sorted (values[f]);
+              std::sort (sorted.begin (), sorted.end ());
+              for (uint32_t k = 0; k < 3; ++k)
+                {
+                  double exact = sorted[(uint32_t)std::ceil (q[k] * nValues[d]) - 1];
+                  maxError = std::max (maxError, std::fabs (hist.GetQuantile (q[k]) - exact) / exact);
+                }
+            }
+          report.SetBytes (bytes / flows);
+          report.SetError (100.0 * maxError);
+
+          std::string variant = std::string (distributions[d]) + "/" + layouts[l];
+          for (report.Start ("HistFlows", variant, nValues[d], flows * nValues[d]); report.Repeat (); )
+            {
+              for (uint32_t f = 0; f < flows; ++f)
+                {
+                  StatsHist hist (l < 2 ? 0.0001 : 0.000001);
+                  hist.SetLogLinear (l < 2 ? 0 : 7);
+                  hist.SetSparse (l % 2 == 1);
+                  for (uint32_t v = 0; v < nValues[d]; ++v)
+                    {
+                      hist.AddValue (values[f][v]);
+                    }
+                  g_sink = g_sink + hist.GetMedianEstimation () + hist.GetQuantile (0.99);
+                }
+            }
+        }
+    }
+}
+
+/////////////////////////////////////////////
+// StatsHist::WriteToCsvFile on large histograms, at the bin width and with
+// ten bins merged per written line
+/////////////////////////////////////////////
+void
+BenchmarkHistWriteCsv (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("HistWriteCsv"))
+    {
+      return;
+    }
+  std::string fileName = "stats-microbenchmark-hist.csv";
+  uint32_t bins[] = {10000, 100000, 1000000};
+  for (uint32_t b = 0; b < 3; ++b)
+    {
+      StatsHist hist (0.0001);
+      FillHist (hist, bins[b]);
+      uint32_t iterations = report.Scale (1000000 / bins[b]);
+      for (uint32_t merge = 0; merge < 2; ++merge)
+        {
+          double writeBinWidth = merge ? 0.001 : 0.0001;
+          for (report.Start ("HistWriteCsv", merge ? "merged-10" : "bin-width", hist.GetNBins (), iterations); report.Repeat (); )
+            {
+              std::remove (fileName.c_str ()); // the file is appended to
+              for (uint32_t i = 0; i < iterations; ++i)
+                {
+                  hist.WriteToCsvFile (fileName, writeBinWidth);
+                }
+            }
+        }
+    }
+  std::remove (fileName.c_str ());
+}
+
+/////////////////////////////////////////////
+// Vector file: cost per record of StatsVectorFile written on the simulator
+// thread (CSV and binary, Open and Close included) and of Write () with the
+// writer thread (only the simulator thread side), compared to opening,
+// appending to and closing the file for every record (the previous writer)
+/////////////////////////////////////////////
+void
+BenchmarkVectorFile (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("VectorFile"))
+    {
+      return;
+    }
+  const uint32_t nFlows = 10;
+  std::string fileName = "stats-microbenchmark-vec";
+
+  uint32_t iterations = report.Scale (20000);
+  for (report.Start ("VectorFileWrite", "open-per-record", nFlows, iterations); report.Repeat (); )
+    {
+      std::ofstream header (fileName.c_str (), std::ofstream::out | std::ofstream::trunc);
+      header << "Flow Index, Time [us], Sequence Id, Delay [us]" << std::endl;
+      header.close ();
+      for (uint32_t i = 0; i < iterations; ++i)
+        {
+          WriteRecordPerOpen (fileName, MicroSeconds (10000 + 100 * i), i % nFlows, i, MicroSeconds (1500 + i % 1000));
+        }
+    }
+
+  StatsVectorFile vectorFile;
+  iterations = report.Scale (1000000);
+  for (uint32_t binary = 0; binary < 2; ++binary)
+    {
+      vectorFile.SetFormat (binary ? StatsVectorFile::BINARY : StatsVectorFile::CSV);
+      for (report.Start ("VectorFileWrite", binary ? "binary" : "csv", nFlows, iterations); report.Repeat (); )
+        {
+          vectorFile.Open (fileName, "Delay [us]");
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              vectorFile.Write (MicroSeconds (10000 + 100 * i), i % nFlows, i, MicroSeconds (1500 + i % 1000));
+            }
+          vectorFile.Close ();
+          report.SetBytes (vectorFile.GetNBytesWritten ());
+        }
+    }
+
+  vectorFile.SetFormat (StatsVectorFile::CSV);
+  for (uint32_t drop = 0; drop < 2; ++drop)
+    {
+      vectorFile.SetAsync (true, 1 << 16, drop ? StatsVectorFile::DROP : StatsVectorFile::BLOCK);
+      vectorFile.Open (fileName, "Delay [us]");
+      for (report.Start ("VectorFileWrite", drop ? "async-drop" : "async-block", nFlows, iterations); report.Repeat (); )
+        {
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              vectorFile.Write (MicroSeconds (10000 + 100 * i), i % nFlows, i, MicroSeconds (1500 + i % 1000));
+            }
+        }
+      vectorFile.Close ();
+    }
+  std::remove (fileName.c_str ());
+}
+
+/////////////////////////////////////////////
+// StatsHeader Serialize and Deserialize (without the packet), IPv4 and IPv6
+// receiver address, full and compact format
+/////////////////////////////////////////////
+void
+BenchmarkHeader (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("Header"))
+    {
+      return;
+    }
+  uint32_t iterations = report.Scale (1000000);
+  Address rxAddresses[] = {InetSocketAddress (Ipv4Address ("10.0.0.1"), 80),
+                           Inet6SocketAddress (Ipv6Address ("2001:db8::1"), 80)};
+  for (uint32_t ip = 0; ip < 2; ++ip)
+    {
+      for (uint32_t compact = 0; compact < 2; ++compact)
+        {
+          StatsHeader txHeader;
+          txHeader.SetNodeId (12);
+          txHeader.SetApplicationId (3);
+          txHeader.SetRxAddress (rxAddresses[ip]);
+          if (compact)
+            {
+              txHeader.SetCompact (StatsHeader::RegisterFlow (12, 3, rxAddresses[ip], Seconds (0)));
+            }
+          Buffer buffer;
+          buffer.AddAtStart (txHeader.GetSerializedSize ());
+          std::string variant = std::string (ip ? "ipv6" : "ipv4") + (compact ? "/compact" : "/full");
+
+          for (report.Start ("HeaderSerialize", variant, txHeader.GetSerializedSize (), iterations); report.Repeat (); )
+            {
+              for (uint32_t i = 0; i < iterations; ++i)
+                {
+                  txHeader.SetSeq (i);
+                  txHeader.Serialize (buffer.Begin ());
+                }
+            }
+
+          StatsHeader rxHeader;
+          for (report.Start ("HeaderDeserialize", variant, txHeader.GetSerializedSize (), iterations); report.Repeat (); )
+            {
+              for (uint32_t i = 0; i < iterations; ++i)
+                {
+                  rxHeader.Deserialize (buffer.Begin ());
+                  g_sink = g_sink + rxHeader.GetSeq ();
+                }
+            }
+          NS_ASSERT_MSG (rxHeader.GetSinkKey () == StatsHeader::GetSinkKey (rxAddresses[ip]), "Header not restored");
+        }
+    }
+  StatsHeader::ClearRegistry ();
+}
+
+/////////////////////////////////////////////
+// NetFlowId comparison (operator==) of equal and of different flows and
+// the NetFlowKey used for the flow lookup, IPv4 and IPv6 receiver address
+/////////////////////////////////////////////
+void
+BenchmarkNetFlowId (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("NetFlowId"))
+    {
+      return;
+    }
+  const uint32_t nFlows = 1024; // power of two, flows are indexed with a mask
+  uint32_t iterations = report.Scale (1000000);
+  for (uint32_t ip = 0; ip < 2; ++ip)
+    {
+      std::vector<NetFlowId> flows;
+      for (uint32_t f = 0; f < nFlows; ++f)
+        {
+          Address sinkAddr = ip ? Address (Inet6SocketAddress (Ipv6Address ("2001:db8::1"), 1000 + f % 16))
+                                : Address (InetSocketAddress (Ipv4Address ("10.0.0.1"), 1000 + f % 16));
+          flows.push_back (NetFlowId (f / 16, f % 16, StatsHeader::GetSinkKey (sinkAddr)));
+        }
+      std::vector<NetFlowId> copies (flows);
+      std::string ipName = ip ? "ipv6" : "ipv4";
+
+      uint32_t matches = 0;
+      for (report.Start ("NetFlowIdCompare", ipName + "/equal", nFlows, iterations); report.Repeat (); )
+        {
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              matches += flows[i & (nFlows - 1)] == copies[i & (nFlows - 1)];
+            }
+        }
+      for (report.Start ("NetFlowIdCompare", ipName + "/different", nFlows, iterations); report.Repeat (); )
+        {
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              matches += flows[i & (nFlows - 1)] == copies[(i + 1) & (nFlows - 1)];
+            }
+        }
+      for (report.Start ("NetFlowIdCompare", ipName + "/key", nFlows, iterations); report.Repeat (); )
+        {
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              matches += flows[i & (nFlows - 1)].GetKey () == copies[(i + 1) & (nFlows - 1)].GetKey ();
+            }
+        }
+      g_sink = g_sink + matches;
+    }
+}
+
+/////////////////////////////////////////////
+// StatsFlows end to end: cost of one sent and received packet as a function of
+// the number of flows, for the TxRecord/RxRecord callbacks with the hash lookup
+// and with flows bound at install time, and for the packet based callbacks
+/////////////////////////////////////////////
+void
+BenchmarkStatsFlows (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("StatsFlows"))
+    {
+      return;
+    }
+  const uint32_t nOrder = 1 << 20; // power of two, the flow order is indexed with a mask
+  uint32_t iterations = report.Scale (1000000);
+  Address sourceAddr = InetSocketAddress (Ipv4Address ("10.2.0.1"), 49153);
+  uint32_t nFlows[] = {10, 100, 1000, 10000, 100000};
+  const char *variants[] = {"record", "record-bound", "packet"};
+
+  for (uint32_t n = 0; n < 5; ++n)
+    {
+      // Visit flows in a random order so that the measurement is not dominated by cache locality
+      std::vector<uint32_t> order (nOrder);
+      Ptr<UniformRandomVariable> var = CreateObject<UniformRandomVariable> ();
+      for (uint32_t p = 0; p < nOrder; ++p)
+        {
+          order[p] = var->GetInteger (0, nFlows[n] - 1);
+        }
+
+      for (uint32_t v = 0; v < 3; ++v)
+        {
+          StatsFlows sf (1, "stats-microbenchmark", false, false); // no output files
+          std::vector<StatsPacketInfo> infos (nFlows[n]);
+          std::vector<Ptr<Packet> > packets;
+          for (uint32_t f = 0; f < nFlows[n]; ++f)
+            {
+              Address rxAddress = InetSocketAddress (Ipv4Address (0x0a000001 + f % 250), 80);
+              if (v == 2)
+                {
+                  StatsHeader statsHeader;
+                  statsHeader.SetNodeId (f / 64);
+                  statsHeader.SetApplicationId (f % 64);
+                  statsHeader.SetRxAddress (rxAddress);
+                  Ptr<Packet> packet = Create<Packet> (128 - statsHeader.GetSerializedSize ());
+                  packet->AddHeader (statsHeader);
+                  packets.push_back (packet);
+                  sf.PacketSent (packet); // first packet creates the flow
+                  continue;
+                }
+              infos[f].seq = 0;
+              infos[f].txTimeStep = 0;
+              infos[f].sourceNodeId = f / 64;
+              infos[f].sourceAppId = f % 64;
+              infos[f].sinkKey = StatsHeader::GetSinkKey (rxAddress);
+              infos[f].size = 128;
+              infos[f].flowSlot = v == 1 ? StatsHeader::RegisterFlow (f / 64, f % 64, rxAddress, Seconds (0))
+                                         : StatsPacketInfo::NO_FLOW_SLOT;
+              sf.TxRecord (infos[f]);
+            }
+
+          for (report.Start ("StatsFlowsPacket", variants[v], nFlows[n], iterations); report.Repeat (); )
+            {
+              if (v == 2)
+                {
+                  for (uint32_t i = 0; i < iterations; ++i)
+                    {
+                      Ptr<Packet> packet = packets[order[i & (nOrder - 1)]];
+                      sf.PacketSent (packet);
+                      sf.PacketReceived (packet, 0, 0, sourceAddr);
+                    }
+                }
+              else
+                {
+                  for (uint32_t i = 0; i < iterations; ++i)
+                    {
+                      const StatsPacketInfo &info = infos[order[i & (nOrder - 1)]];
+                      sf.TxRecord (info);
+                      sf.RxRecord (info, 0, 0, sourceAddr);
+                    }
+                }
+            }
+          sf.Clear ();
+          StatsHeader::ClearRegistry (); // no packets of the bound flows are left
+        }
+    }
+}
+
+/////////////////////////////////////////////
+// Device Tx trace: cost per transmission of the context based connection
+// (Config::Connect, context string passed on every transmission) compared
+// to the StatsOverheadCollector counter bound without context
+/////////////////////////////////////////////
+void
+BenchmarkDeviceTx (BenchmarkReport &report)
+{
+  if (!report.IsSelected ("DeviceTx"))
+    {
+      return;
+    }
+  uint32_t iterations = report.Scale (10000000);
+  std::vector<StatsOverheadCollector::DeviceCounter> counters (1);
+  Ptr<const Packet> packet = Create<Packet> (1500);
+  for (uint32_t bound = 0; bound < 2; ++bound)
+    {
+      // same trace source type as CsmaNetDevice/PointToPointNetDevice "PhyTxBegin"
+      TracedCallback<Ptr<const Packet> > phyTxTrace;
+      if (bound)
+        {
+          phyTxTrace.ConnectWithoutContext (MakeBoundCallback (&StatsOverheadCollector::CountTx<Ptr<const Packet> >, &counters, 0));
+        }
+      else
+        {
+          phyTxTrace.Connect (MakeCallback (&ContextTx), "/NodeList/123/DeviceList/0/PhyTxBegin");
+        }
+      for (report.Start ("DeviceTx", bound ? "bound-counter" : "context", 1, iterations); report.Repeat (); )
+        {
+          for (uint32_t i = 0; i < iterations; ++i)
+            {
+              phyTxTrace (packet);
+            }
+        }
+    }
+  g_sink = g_sink + g_contextTxBytes + counters[0].txBytes;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string format = "csv";
+  std::string outputFile = "";
+  std::string label = "";
+  std::string filter = "";
+  uint32_t repeats = 5;
+  double scale = 1.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("format", "Output format: csv or json (one JSON object per line).", format);
+  cmd.AddValue ("output", "Append the results to this file instead of printing them.", outputFile);
+  cmd.AddValue ("label", "Label of every result line, e.g. the commit or build being measured.", label);
+  cmd.AddValue ("filter", "Run only benchmarks whose name contains this string, e.g. Hist.", filter);
+  cmd.AddValue ("repeats", "Number of measured repeats (after one warm-up repeat).", repeats);
+  cmd.AddValue ("scale", "Multiplier of the number of operations per repeat (e.g. 0.1 for a quick run).", scale);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (format != "csv" && format != "json", "Unknown output format " << format);
+  NS_ABORT_MSG_IF (label.find_first_of (",\"") != std::string::npos, "Label must not contain commas or quotes");
+
+  std::ofstream file;
+  bool newFile = true;
+  if (!outputFile.empty ())
+    {
+      file.open (outputFile.c_str (), std::ofstream::out | std::ofstream::app);
+      NS_ABORT_MSG_IF (!file.is_open (), "Cannot open " << outputFile);
+      file.seekp (0, std::ios_base::end);
+      newFile = file.tellp () == 0;
+    }
+  BenchmarkReport report (outputFile.empty () ? std::cout : file, format == "json", label, filter, repeats, scale);
+  if (newFile)
+    {
+      report.WriteHeader ();
+    }
+
+  BenchmarkHistAddValue (report);
+  BenchmarkHistMedian (report);
+  BenchmarkHistQuantile (report);
+  BenchmarkHistMerge (report);
+  BenchmarkHistFlows (report);
+  BenchmarkHistWriteCsv (report);
+  BenchmarkVectorFile (report);
+  BenchmarkHeader (report);
+  BenchmarkNetFlowId (report);
+  BenchmarkStatsFlows (report);
+  BenchmarkDeviceTx (report);
+
+  Simulator::Destroy ();
+  return 0;
+}
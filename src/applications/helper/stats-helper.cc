@@ -32,6 +32,8 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/stats-packet-source.h"
 #include "ns3/stats-packet-sink.h"
+#include "ns3/stats-header.h"
+#include "ns3/simulator.h"
 #include "ns3/string.h"
 
 namespace ns3 {
@@ -42,6 +44,7 @@ namespace ns3 {
 
 
 StatsSourceHelper::StatsSourceHelper (std::string protocol, Address address)
+  : m_bindFlows (false)
 {
   m_factory.SetTypeId ("ns3::StatsPacketSource");
   m_factory.Set ("Protocol", StringValue (protocol));
@@ -83,11 +86,24 @@ Ptr<Application>
 StatsSourceHelper::InstallPriv (Ptr<Node> node) const
 {
   Ptr<Application> app = m_factory.Create<Application> ();
-  node->AddApplication (app);
+  uint32_t appIndex = node->AddApplication (app);
+  if (m_bindFlows)
+    {
+      AddressValue remote;
+      app->GetAttribute ("Remote", remote);
+      uint32_t slot = StatsHeader::RegisterFlow (node->GetId (), appIndex, remote.Get (), Simulator::Now ());
+      app->SetAttribute ("FlowSlot", UintegerValue (slot));
+    }
 
   return app;
 }
 
+void
+StatsSourceHelper::SetFlowBinding (bool bind)
+{
+  m_bindFlows = bind;
+}
+
 int64_t
 StatsSourceHelper::AssignStreams (NodeContainer c, int64_t stream)
 {
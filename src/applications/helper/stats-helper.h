@@ -124,6 +124,16 @@ public:
   */
   int64_t AssignStreams (NodeContainer c, int64_t stream);
 
+  /**
+   * Bind flows at install time. Every installed StatsPacketSource gets its flow
+   * registered (StatsHeader::RegisterFlow) and sends the flow id (flow slot) in the
+   * compact StatsHeader, so StatsFlows finds the flow of every sent and received
+   * packet by a direct array index instead of a hash lookup.
+   *
+   * \param bind true to bind flows of applications installed from now on
+   */
+  void SetFlowBinding (bool bind);
+
 private:
   /**
    * Install an ns3::StatsPacketSource on the node configured with all the 
@@ -135,6 +145,7 @@ private:
   Ptr<Application> InstallPriv (Ptr<Node> node) const;
 
   ObjectFactory m_factory; //!< Object factory.
+  bool m_bindFlows; //!< Register flows at install time
 };
 
 
@@ -1,536 +1,805 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
-/*
- * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the GNU General Public License version 2 as
- * published by the Free Software Foundation;
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program; if not, write to the Free Software
- * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
- *
- * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
- *                       <nen.jevtic@gmail.com>
- *          Marija Malnar <m.malnar@sf.bg.ac.rs>
- */
- 
-#include <sstream>
-#include <iostream>
-#include <algorithm>
-
-#include "ns3/simulator.h"
-#include "ns3/address-utils.h"
-#include "ns3/log.h"
-#include "ns3/ipv4-address.h"
-#include "ns3/ipv6-address.h"
-#include "ns3/nstime.h"
-#include "ns3/config.h"
-
-#include "ns3/stats-header.h"
-#include "ns3/stats-data.h"
-
-
-namespace ns3 {
-
-NS_LOG_COMPONENT_DEFINE ("StatsData");
-
-/*******************************************************
- * Summary & RunSummary
- *******************************************************/
-void
-Summary::IterativeAdd (const Summary &s, unsigned iteration)
-{
-  duration = (duration * (iteration-1) + s.duration) / iteration;
-  throughput = (throughput * (iteration-1) + s.throughput) / iteration;
-  txPackets = (txPackets * (iteration-1) + s.txPackets) / iteration;
-  rxPackets = (rxPackets * (iteration-1) + s.rxPackets) / iteration;
-  lostPackets = (lostPackets * (iteration-1) + s.lostPackets) / iteration;
-  lostRatio = (lostRatio * (iteration-1) + s.lostRatio) / iteration;
-  e2eDelayMin = (e2eDelayMin * (iteration-1) + s.e2eDelayMin) / iteration;
-  e2eDelayMax = (e2eDelayMax * (iteration-1) + s.e2eDelayMax) / iteration;
-  e2eDelayAverage = (e2eDelayAverage * (iteration-1) + s.e2eDelayAverage) / iteration;
-  e2eDelayMedianEstinate = (e2eDelayMedianEstinate * (iteration-1) + s.e2eDelayMedianEstinate) / iteration;
-  e2eDelayJitter = (e2eDelayJitter * (iteration-1) + s.e2eDelayJitter) / iteration;
-}
-
-/******************************************************
- * NetFlowId
- *******************************************************/
-std::string
-NetFlowId::ToString ()
-{
-  std::ostringstream oss;
-  oss << flowIndex << ": " << sourceNodeId << "-" << sourceAppId << "( ";
-
-  if (InetSocketAddress::IsMatchingType (sourceAddr))
-    {
-      oss << InetSocketAddress::ConvertFrom (sourceAddr).GetIpv4 ()
-          << ":" << InetSocketAddress::ConvertFrom (sourceAddr).GetPort ();
-    }
-  else if (Inet6SocketAddress::IsMatchingType (sourceAddr))
-    {
-      oss << "[" << Inet6SocketAddress::ConvertFrom (sourceAddr).GetIpv6 ()
-          << "]:" << Inet6SocketAddress::ConvertFrom (sourceAddr).GetPort ();
-    }
-  else
-    {
-      oss << "<not valid>";
-    }    
-      
-  oss << " ) ---> " << sinkNodeId << "-" << sinkAppId << "( ";
-
-  if (InetSocketAddress::IsMatchingType (sinkAddr))
-    {
-      oss << InetSocketAddress::ConvertFrom (sinkAddr).GetIpv4 ()
-          << ":" << InetSocketAddress::ConvertFrom (sinkAddr).GetPort ();
-    }
-  else if (Inet6SocketAddress::IsMatchingType (sinkAddr))
-    {
-      oss << "[" << Inet6SocketAddress::ConvertFrom (sinkAddr).GetIpv6 ()
-          << "]:" << Inet6SocketAddress::ConvertFrom (sinkAddr).GetPort ();
-    }
-  else
-    {
-      oss << "<not valid>";
-    }    
-
-  oss << " )";
-  return oss.str ();
-}
-
-std::string
-NetFlowId::ToCsvString ()
-{
-  std::ostringstream oss;
-  oss << flowIndex << "," << sourceNodeId << "," << sourceAppId << ",";
-
-  if (InetSocketAddress::IsMatchingType (sourceAddr))
-    {
-      oss << InetSocketAddress::ConvertFrom (sourceAddr).GetIpv4 ()
-          << ":" << InetSocketAddress::ConvertFrom (sourceAddr).GetPort ();
-    }
-  else if (Inet6SocketAddress::IsMatchingType (sourceAddr))
-    {
-      oss << "[" << Inet6SocketAddress::ConvertFrom (sourceAddr).GetIpv6 ()
-          << "]:" << Inet6SocketAddress::ConvertFrom (sourceAddr).GetPort ();
-    }
-  else
-    {
-      oss << "<not valid>";
-    }    
-      
-  oss << "," << sinkNodeId << "," << sinkAppId << ",";
-
-  if (InetSocketAddress::IsMatchingType (sinkAddr))
-    {
-      oss << InetSocketAddress::ConvertFrom (sinkAddr).GetIpv4 ()
-          << ":" << InetSocketAddress::ConvertFrom (sinkAddr).GetPort ();
-    }
-  else if (Inet6SocketAddress::IsMatchingType (sinkAddr))
-    {
-      oss << "[" << Inet6SocketAddress::ConvertFrom (sinkAddr).GetIpv6 ()
-          << "]:" << Inet6SocketAddress::ConvertFrom (sinkAddr).GetPort ();
-    }
-  else
-    {
-      oss << "<not valid>";
-    }    
-
-  return oss.str ();
-}
-
-/*******************************************************
- * FlowData
- *******************************************************/
-FlowData::FlowData (NetFlowId fid, std::string fn, bool scalarFileWriteEnable,
-                    bool vectorFileWriteEnable, double histRes)
-    : m_flowId (fid),
-      m_fileName (fn),
-      m_scalarData (histRes),
-      m_delayVector ("Delay [us]"),
-      m_scalarFileWriteEnable (scalarFileWriteEnable),
-      m_vectorFileWriteEnable (vectorFileWriteEnable)
-{
-  NS_LOG_FUNCTION (this);
-}
-
-void 
-FlowData::PacketReceived (Ptr<const Packet> packet)
-{
-  NS_LOG_FUNCTION (this);
-
-  // If this is the first packet received at all, write file header
-  if (IsVectorFileWriteEnabled () &&  m_flowId.flowIndex == 0 && m_scalarData.totalRxPackets == 0)
-    {
-      m_delayVector.WriteFileHeader (m_fileName + "-vec.csv");
-    }
-
-  StatsHeader statsHeader;
-  packet->PeekHeader (statsHeader);
-  
-  // Scalar data
-  m_scalarData.totalRxPackets++; // number of received packets
-  m_scalarData.packetSizeInBytes = packet->GetSize (); // last packet's size
-  m_scalarData.totalRxBytes += m_scalarData.packetSizeInBytes; // total bytes received
-  uint32_t currentSequenceNumber = statsHeader.GetSeq (); // SeqNo is counting from 0, so (SeqNo + 1) is equal to the number of packets sent
-  m_scalarData.lastPacketReceived = Simulator::Now ();
-  Time lastPacketReceivedIsSent = statsHeader.GetTs ();
-  m_scalarData.lastDelay = m_scalarData.lastPacketReceived - lastPacketReceivedIsSent;
-  if (m_scalarData.totalRxPackets == 1) // first received packet
-  {
-    m_scalarData.firstPacketReceived = m_scalarData.lastPacketReceived;
-    m_scalarData.firstDelay = m_scalarData.lastDelay; // Warning: actual first packet sent can be lost
-  }
-  m_scalarData.delayHist.AddValue (m_scalarData.lastDelay.GetSeconds ());
-
-  // vector data
-  if (IsVectorFileWriteEnabled ()) 
-    {
-      m_delayVector.WriteValueToFile (m_fileName + "-vec.csv", m_scalarData.lastPacketReceived, m_scalarData.lastDelay, m_flowId.flowIndex, currentSequenceNumber);
-    }
-}
-
-void 
-FlowData::PacketSent (Ptr<const Packet> packet)
-{
-  NS_LOG_FUNCTION (this);
-  StatsHeader statsHeader;
-  packet->PeekHeader (statsHeader);
-  
-  // Scalar data
-  m_scalarData.totalTxPackets++; // number of transmitted packets
-  m_scalarData.packetSizeInBytes = packet->GetSize (); // last packet's size
-  m_scalarData.totalTxBytes += m_scalarData.packetSizeInBytes; // total bytes transmitted 
-
-  m_scalarData.lastPacketSent = statsHeader.GetTs ();
-  if (m_scalarData.totalTxPackets == 1) // first received packet
-  {
-    m_scalarData.firstPacketSent = m_scalarData.lastPacketSent;
-  }
-}
-
-
-Summary
-FlowData::Finalize ()
-{
-  NS_LOG_FUNCTION (this);
-
-  Summary s;
-  Time endOfTransmition = (m_scalarData.lastPacketSent - m_scalarData.lastPacketReceived > 0)
-                          ? (m_scalarData.lastPacketSent) : (m_scalarData.lastPacketReceived);
-  s.duration = (endOfTransmition - m_scalarData.firstPacketSent).GetSeconds ();
-  if (s.duration > 0)
-    {
-      s.throughput = 8.0 * (double)m_scalarData.totalRxBytes / s.duration;
-    }
-  else
-    {
-      s.throughput = 0.0;
-    }
-  s.txPackets = m_scalarData.totalTxPackets;
-  s.rxPackets = m_scalarData.totalRxPackets;
-  s.lostPackets = m_scalarData.totalTxPackets - m_scalarData.totalRxPackets;
-  s.lostRatio = 100*s.lostPackets/s.txPackets;
-  s.e2eDelayMin = m_scalarData.delayHist.GetMin ();
-  s.e2eDelayMax = m_scalarData.delayHist.GetMax ();
-  s.e2eDelayAverage = m_scalarData.delayHist.GetMean ();
-  s.e2eDelayMedianEstinate = m_scalarData.delayHist.GetMedianEstimation ();
-  s.e2eDelayJitter = m_scalarData.delayHist.GetStdDev ();
-
-  if (IsScalarFileWriteEnabled ())
-  {
-    std::ofstream out;
-    if (m_flowId.flowIndex == 0)
-      { // all data go to one file, so when FlowId==0 then delete old file if it exists and start new file
-        out.open ((m_fileName + "-sca.csv").c_str (), std::ofstream::out | std::ofstream::trunc);
-      }
-    else
-      { // if FlowId>0 new file is already created and now just append to the end of the file
-        out.open ((m_fileName + "-sca.csv").c_str (), std::ofstream::out | std::ofstream::app);
-      }
-    out << std::endl;
-    out << "Flow Index, Source Node, Source App, Source Address, Sink Node, Sink App, Sink Address" << std::endl;
-    out << m_flowId.ToCsvString () << std::endl;
-    out << "Number of Rx packets for flow:," << s.rxPackets
-        << ", written to file:, " << m_delayVector.GetNValuesWrittenToFile ()
-        << ", written to hist:, " << m_scalarData.delayHist.GetCount ()
-        << std::endl;
-    out << std::endl;
-    out << "Last packet length [B]:,"  << m_scalarData.packetSizeInBytes << std::endl;
-    out << "Transmission duration [s]:,"  << s.duration << std::endl;
-    out << "Throughput [bps]:," << s.throughput << std::endl;
-    out << "Tx packets:," << s.txPackets << std::endl;
-    out << "Rx packets:," << s.rxPackets << std::endl;
-    out << "Lost packets:," << s.lostPackets << std::endl;
-    out << "Lost packet ratio [%]:," << s.lostRatio << std::endl;
-    out << "E2E delay - Min [ms]," << 1000.0*s.e2eDelayMin << std::endl;
-    out << "E2E delay - Max [ms]," << 1000.0*s.e2eDelayMax << std::endl;
-    out << "E2E delay - Average [ms]," << 1000.0*s.e2eDelayAverage << std::endl;
-    out << "E2E delay - Median estimate (+/-" << 1000.0 * 0.5 *m_scalarData.delayHist.GetBinWidth () << ") [ms]:," << 1000.0*s.e2eDelayMedianEstinate << std::endl;
-    out << "E2E delay - Jitter [ms]," << 1000.0*s.e2eDelayJitter << std::endl;
-    out << std::endl;
-    out << "Rx," << "First packet [us]:," << m_scalarData.firstPacketReceived.GetMicroSeconds () << std::endl;
-    out << "Rx,"<< "Last packet [us]:," << m_scalarData.lastPacketReceived.GetMicroSeconds () << std::endl;
-    Time diffRx = m_scalarData.lastPacketReceived - m_scalarData.firstPacketReceived;
-    out << "Rx,"<< "Receiving duration [s]:,"  << diffRx.GetSeconds () << std::endl;
-    out << "Rx,"<< "Count of packets:,"  << m_scalarData.totalRxPackets << std::endl;
-    out << "Rx,"<< "Total bytes:,"  << m_scalarData.totalRxBytes << std::endl;
-    if (diffRx.GetSeconds ())
-      {
-        out << "Rx,"<< "Throughput [bps]:,"  << 8.0 * (double)m_scalarData.totalRxBytes / diffRx.GetSeconds () << std::endl;
-      }
-    else
-      {
-        out << "Rx,"<< "Throughput [bps]:,"  << 0.0 << std::endl;
-      }
-    out << std::endl;
-    out << "Tx," << "First packet [us]:," << m_scalarData.firstPacketSent.GetMicroSeconds () << std::endl;
-    out << "Tx,"<< "Last packet [us]:," << m_scalarData.lastPacketSent.GetMicroSeconds () << std::endl;
-    Time diffTx = m_scalarData.lastPacketSent - m_scalarData.firstPacketSent;
-    out << "Tx,"<< "Sending duration [s]:,"  << diffTx.GetSeconds () << std::endl;
-    out << "Tx,"<< "Count of packets:,"  << m_scalarData.totalTxPackets << std::endl;
-    out << "Tx,"<< "Total bytes:,"  << (m_scalarData.totalTxBytes) << std::endl;
-    if (diffTx.GetSeconds ())
-      {
-        out << "Tx,"<< "Throughput [bps]:,"  << 8.0 * (double)(m_scalarData.totalTxBytes) / diffTx.GetSeconds () << std::endl;
-      }
-    else
-      {
-        out << "Tx,"<< "Throughput [bps]:,"  << 0.0 << std::endl;
-      }
-    out << std::endl;
-    out.close ();
-  }
-  return s;
-}
-
-/******************************************************
- * StatsFlows
- *******************************************************/
-StatsFlows::StatsFlows (uint64_t rngRun, std::string fn, bool scalarFileWriteEnable, bool vectorFileWriteEnable) :
-    m_rngRun (rngRun),
-    m_fileName (fn + "-Run_" + std::to_string (rngRun)),
-    m_scalarFileWriteEnable (scalarFileWriteEnable),
-    m_vectorFileWriteEnable (vectorFileWriteEnable),
-    m_histogramResolution (0.0001) // 0.1 ms
-{ 
-  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::StatsPacketSink/Rx", MakeCallback (&StatsFlows::PacketReceived, this));
-  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::StatsPacketSource/Tx", MakeCallback (&StatsFlows::PacketSent, this));
-  // every device will have PHY callback for tracing
-  // which is used to determine the total amount of
-  // data transmitted, and then used to calculate
-  // the MAC/PHY overhead beyond the app-data
-  Config::Connect ("/NodeList/*/DeviceList/*/Phy/State/Tx", MakeCallback (&StatsFlows::PhyPacketSent, this));
-  //NodeList/[i]/DeviceList/[i]/$ns3::WifiNetDevice/Phy/$ns3::YansWifiPhy/State
-}
- 
-
-
-void
-StatsFlows::PhyPacketSent (std::string context, Ptr<const Packet> packet, WifiMode mode, WifiPreamble preamble, uint8_t txPower)
-{
-  NS_LOG_FUNCTION (this << context << packet << "PHYTX mode=" << mode );
-  m_allPacketsStats.phyTxPkts++;
-  uint32_t pktSize = packet->GetSize ();
-  m_allPacketsStats.phyTxBytes += pktSize;
-  //NS_LOG_UNCOND ("Received PHY size=" << pktSize);
-}
-
- 
-void
-StatsFlows::PacketSent (Ptr<const Packet> packet)
-{
-  NS_LOG_FUNCTION (this);
-
-  StatsHeader statsHeader;
-  packet->PeekHeader (statsHeader);
-  NS_LOG_INFO ("Packet header: " << statsHeader.ToString ());
-
-  // All runs scalar statistics
-  m_allPacketsStats.totalTxPackets++; // number of transmitted packets
-  m_allPacketsStats.packetSizeInBytes = packet->GetSize (); // last packet's size
-  m_allPacketsStats.totalTxBytes += m_allPacketsStats.packetSizeInBytes; // total bytes transmitted
-  m_allPacketsStats.lastPacketSent = statsHeader.GetTs ();
-  if (m_allPacketsStats.totalTxPackets == 1) // first received packet
-  {
-	  m_allPacketsStats.firstPacketSent = m_allPacketsStats.lastPacketSent;
-  }
-  NS_LOG_INFO ("Packet sent: " << m_allPacketsStats.totalTxPackets);
-
-  // Detecting FlowId
-  uint32_t sourceNodeId = statsHeader.GetNodeId ();
-  uint32_t sourceAppId = statsHeader.GetApplicationId ();
-  Address sinkAddr = statsHeader.GetRxAddress ();
-  NetFlowId fid (sourceNodeId, sourceAppId, sinkAddr);
-  NS_LOG_INFO ("Flow: " << fid.ToString ());
-  
-  // Search for existing FlowIds
-  uint16_t i;
-  for (i = 0; i < m_flowData.size(); i++)
-  {
-    if (fid == m_flowData[i].GetFlowId ()) break;
-  }
-  if (i == m_flowData.size()) // not found -> new FlowId
-  {
-    fid.flowIndex = i;
-    FlowData fd (fid, m_fileName, m_scalarFileWriteEnable, m_vectorFileWriteEnable, m_histogramResolution);
-    m_flowData.push_back (fd);
-    NS_LOG_INFO ("New flow [size=" << m_flowData.size () << "]: " << m_flowData[i].GetFlowId ().ToString ());
-  }
-  else // found existing FlowId
-  {
-    NS_LOG_INFO ("Flow found: [size=" << m_flowData.size () << "]: " << m_flowData[i].GetFlowId ().ToString ());
-  }
-  
-  m_flowData[i].PacketSent (packet); // call apps statistics calculations for this particular FlowId
-}
-
-void
-StatsFlows::PacketReceived (Ptr<const Packet> packet, uint32_t sinkNodeId, uint32_t sinkAppId, Address sourceAddr)
-{
-  NS_LOG_FUNCTION (this);
-
-  StatsHeader statsHeader;
-  packet->PeekHeader (statsHeader);
-  NS_LOG_INFO ("Packet header: " << statsHeader.ToString ());
-
-  // Scalar data for all runs
-  m_allPacketsStats.totalRxPackets++; // number of received packets
-  m_allPacketsStats.packetSizeInBytes = packet->GetSize (); // last packet's size
-  m_allPacketsStats.totalRxBytes += m_allPacketsStats.packetSizeInBytes; // total bytes received
-  m_allPacketsStats.lastPacketReceived = Simulator::Now ();
-  Time lastPacketReceivedIsSent = statsHeader.GetTs ();
-  m_allPacketsStats.lastDelay = m_allPacketsStats.lastPacketReceived - lastPacketReceivedIsSent;
-  if (m_allPacketsStats.totalRxPackets == 1) // first received packet
-    {
-      m_allPacketsStats.firstPacketReceived = m_allPacketsStats.lastPacketReceived;
-      m_allPacketsStats.firstDelay = m_allPacketsStats.lastDelay; // Warning: actual first packet sent can be lost
-    }
-  m_allPacketsStats.delayHist.AddValue (m_allPacketsStats.lastDelay.GetSeconds ());
-  NS_LOG_INFO ("Packet received: " << m_allPacketsStats.totalRxPackets);
-  NS_LOG_INFO (m_allPacketsStats.totalRxPackets);
-
-  // Detecting FlowId
-  uint32_t sourceNodeId = statsHeader.GetNodeId ();
-  uint32_t sourceAppId = statsHeader.GetApplicationId ();
-  Address sinkAddr = statsHeader.GetRxAddress ();
-  NetFlowId fid (sourceNodeId, sourceAppId, sinkAddr, sinkNodeId, sinkAppId, sourceAddr);
-  
-  // Search for existing FlowIds
-  uint16_t i;
-  for (i = 0; i < m_flowData.size(); i++)
-  {
-    if (fid == m_flowData[i].GetFlowId ()) break;
-  }
-  if (i == m_flowData.size()) // not found in existing FlowIds
-  {
-    NS_LOG_INFO (">>>>>>>>>>>>>>  New Flow, not possible, assert!!! >>>>>>>>>>>>>>>>>>>>>");
-    NS_LOG_INFO ("Packet stats header: " << statsHeader.ToString ());
-    NS_LOG_INFO ("Existing flows:");
-    for (i = 0; i < m_flowData.size(); i++)
-    {
-       NS_LOG_INFO (m_flowData[i].GetFlowId ().ToString ());
-    }
-    NS_LOG_INFO ("New Flow: [size=" << m_flowData.size () << "]: " << fid.ToString ());
-    NS_ASSERT_MSG (0, "New Flow, not possible, assert!!!");
-  }
-  else // Flow exists
-  {
-    if (m_flowData[i].IsFirstPacketReceived ())
-      {
-        m_flowData[i].GetFlowId ().sinkNodeId = sinkNodeId;
-        m_flowData[i].GetFlowId ().sinkAppId = sinkAppId;
-        m_flowData[i].GetFlowId ().sourceAddr = sourceAddr;
-      }
-    NS_LOG_INFO ("Flow found: [size=" << m_flowData.size () << "]: " << m_flowData[i].GetFlowId ().ToString ());      
-  }
-  
-  m_flowData[i].PacketReceived (packet); // call statistics calculations for this particular FlowId
-}
-
-RunSummary
-StatsFlows::Finalize ()
-{
-  NS_LOG_FUNCTION (this);
-  
-  RunSummary srs;
-  srs.numberOfFlows = m_flowData.size();
-
-  // All packets average summary
-  Time endOfTransmition = (m_allPacketsStats.lastPacketSent - m_allPacketsStats.lastPacketReceived > 0)
-                          ? (m_allPacketsStats.lastPacketSent) : (m_allPacketsStats.lastPacketReceived);
-  srs.aap.duration = (endOfTransmition - m_allPacketsStats.firstPacketSent).GetSeconds ();
-  srs.aap.throughput = (double)m_allPacketsStats.totalRxBytes * 8.0 / srs.aap.duration;
-  srs.aap.txPackets = m_allPacketsStats.totalTxPackets;
-  srs.aap.rxPackets = m_allPacketsStats.totalRxPackets;
-  srs.aap.lostPackets = m_allPacketsStats.totalTxPackets - m_allPacketsStats.totalRxPackets;
-  srs.aap.lostRatio = 100.0* (double)srs.aap.lostPackets / (double)srs.aap.txPackets;
-  srs.aap.phyTxPkts = m_allPacketsStats.phyTxPkts;
-  srs.aap.usefullNetTraffic = (double)m_allPacketsStats.totalTxBytes / (double)m_allPacketsStats.phyTxBytes * 100.0;
-  srs.aap.e2eDelayMin = m_allPacketsStats.delayHist.GetMin ();
-  srs.aap.e2eDelayMax = m_allPacketsStats.delayHist.GetMax ();
-  srs.aap.e2eDelayAverage = m_allPacketsStats.delayHist.GetMean ();
-  srs.aap.e2eDelayMedianEstinate = m_allPacketsStats.delayHist.GetMedianEstimation ();
-  srs.aap.e2eDelayJitter = m_allPacketsStats.delayHist.GetStdDev ();
-
-  // All flows average summary
-  for (uint16_t i = 0; i < srs.numberOfFlows; i++)
-    {
-      NS_LOG_INFO ("FINALIZE: call Finalize() for flowId=" << i);
-      // Calculates all flows average and also writes flow summary to scalar file if enabled
-      srs.aaf.IterativeAdd(m_flowData[i].Finalize (), i+1);
-    }
-
-  if (IsScalarFileWriteEnabled ())
-    {
-      std::ofstream out;
-      if (srs.numberOfFlows == 0)
-        { // no flows, so open new file (delete old if exists)
-          out.open ((m_fileName + "-sca.csv").c_str (), std::ofstream::out | std::ofstream::trunc);
-        }
-      else
-        { // file is already used when writing flow sumary
-          out.open ((m_fileName + "-sca.csv").c_str (), std::ofstream::out | std::ofstream::app);
-        }
-      out << std::endl;
-      out << "AVERAGE RESULTS, Average of all flows (" << srs.numberOfFlows << "), Average of all packets" << std::endl;
-      out << "Transmission duration [s]:," << srs.aaf.duration << "," << srs.aap.duration << std::endl;
-      out << "Throughput [bps]:," << srs.aaf.throughput << "," << srs.aap.throughput << std::endl;
-      out << "Tx packets:," << srs.aaf.txPackets << "," << srs.aap.txPackets << std::endl;
-      out << "Rx packets:," << srs.aaf.rxPackets << "," << srs.aap.rxPackets << std::endl;
-      out << "Lost packets:," << srs.aaf.lostPackets << "," << srs.aap.lostPackets << std::endl;
-      out << "Lost packet ratio [%]:," << srs.aaf.lostRatio << "," << srs.aap.lostRatio << std::endl;
-      out << "PHY Tx packets:," << "," << srs.aap.phyTxPkts << std::endl;
-      out << "PHY over APP traffic ratio [%]:," << "," << srs.aap.usefullNetTraffic << std::endl;
-      out << "E2E delay - Min [ms]:," << 1000.0*srs.aaf.e2eDelayMin << "," << 1000.0*srs.aap.e2eDelayMin << std::endl;
-      out << "E2E delay - Max [ms]:," << 1000.0*srs.aaf.e2eDelayMax << "," << 1000.0*srs.aap.e2eDelayMax << std::endl;
-      out << "E2E delay - Average [ms]:," << 1000.0*srs.aaf.e2eDelayAverage << "," << 1000.0*srs.aap.e2eDelayAverage << std::endl;
-      out << "E2E delay - Median estimate (+/-" << 1000.0 * 0.5 *m_allPacketsStats.delayHist.GetBinWidth () << ") [ms]:," << 1000.0*srs.aaf.e2eDelayMedianEstinate << "," << 1000.0*srs.aap.e2eDelayMedianEstinate << std::endl;
-      out << "E2E delay - Jitter [ms]:," << 1000.0*srs.aaf.e2eDelayJitter << "," << 1000.0*srs.aap.e2eDelayJitter << std::endl;
-      out << std::endl;
-      out.close ();
-      m_allPacketsStats.delayHist.WriteToCsvFile (m_fileName + "-sca.csv", 0.0001, "E2E Delay Hist:");
-    }
-  Clear ();
-  return srs;
-}
-
-void
-StatsFlows::Clear ()
-{
-  m_allPacketsStats.Clear ();
-  for (uint16_t i = 0; i < m_flowData.size(); i++)
-    {
-      m_flowData[i].Clear ();
-    }
-  m_flowData.clear ();
-}
-
-
-} // namespace ns3
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+ 
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <limits>
+
+#include "ns3/simulator.h"
+#include "ns3/address-utils.h"
+#include "ns3/log.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+
+#include "ns3/stats-header.h"
+#include "ns3/stats-memory.h"
+#include "ns3/stats-data.h"
+
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsData");
+
+/*******************************************************
+ * Summary & RunSummary
+ *******************************************************/
+void
+Summary::IterativeAdd (const Summary &s, unsigned iteration)
+{
+  duration = (duration * (iteration-1) + s.duration) / iteration;
+  throughput = (throughput * (iteration-1) + s.throughput) / iteration;
+  txPackets = (txPackets * (iteration-1) + s.txPackets) / iteration;
+  rxPackets = (rxPackets * (iteration-1) + s.rxPackets) / iteration;
+  lostPackets = (lostPackets * (iteration-1) + s.lostPackets) / iteration;
+  lostRatio = (lostRatio * (iteration-1) + s.lostRatio) / iteration;
+  e2eDelayMin = (e2eDelayMin * (iteration-1) + s.e2eDelayMin) / iteration;
+  e2eDelayMax = (e2eDelayMax * (iteration-1) + s.e2eDelayMax) / iteration;
+  e2eDelayAverage = (e2eDelayAverage * (iteration-1) + s.e2eDelayAverage) / iteration;
+  e2eDelayMedianEstinate = (e2eDelayMedianEstinate * (iteration-1) + s.e2eDelayMedianEstinate) / iteration;
+  e2eDelayJitter = (e2eDelayJitter * (iteration-1) + s.e2eDelayJitter) / iteration;
+  e2eDelayP90 = (e2eDelayP90 * (iteration-1) + s.e2eDelayP90) / iteration;
+  e2eDelayP95 = (e2eDelayP95 * (iteration-1) + s.e2eDelayP95) / iteration;
+  e2eDelayP99 = (e2eDelayP99 * (iteration-1) + s.e2eDelayP99) / iteration;
+  e2eDelayP999 = (e2eDelayP999 * (iteration-1) + s.e2eDelayP999) / iteration;
+}
+
+namespace {
+// Members of Summary, in declaration order
+double Summary::* const g_summaryValues[Summary::N_VALUES] = {
+  &Summary::duration, &Summary::throughput, &Summary::txPackets, &Summary::rxPackets,
+  &Summary::lostPackets, &Summary::lostRatio, &Summary::phyTxPkts, &Summary::usefullNetTraffic,
+  &Summary::e2eDelayMin, &Summary::e2eDelayMax, &Summary::e2eDelayAverage, &Summary::e2eDelayMedianEstinate,
+  &Summary::e2eDelayJitter, &Summary::e2eDelayP90, &Summary::e2eDelayP95, &Summary::e2eDelayP99, &Summary::e2eDelayP999
+};
+const char * const g_summaryValueNames[Summary::N_VALUES] = {
+  "duration", "throughput", "txPackets", "rxPackets",
+  "lostPackets", "lostRatio", "phyTxPkts", "usefullNetTraffic",
+  "e2eDelayMin", "e2eDelayMax", "e2eDelayAverage", "e2eDelayMedianEstinate",
+  "e2eDelayJitter", "e2eDelayP90", "e2eDelayP95", "e2eDelayP99", "e2eDelayP999"
+};
+} // anonymous namespace
+
+const char *
+Summary::GetValueName (uint32_t index)
+{
+  NS_ASSERT_MSG (index < N_VALUES, "Summary value index out of range.");
+  return g_summaryValueNames[index];
+}
+
+uint32_t
+Summary::GetValueIndex (std::string name)
+{
+  uint32_t index = 0;
+  while (index < N_VALUES && name != g_summaryValueNames[index])
+    {
+      index++;
+    }
+  return index;
+}
+
+double
+Summary::GetValue (uint32_t index) const
+{
+  NS_ASSERT_MSG (index < N_VALUES, "Summary value index out of range.");
+  return this->*g_summaryValues[index];
+}
+
+void
+RunSummary::Serialize (std::ostream &os) const
+{
+  uint32_t flows = numberOfFlows;
+  os.write ((const char *)&flows, sizeof (flows));
+  os.write ((const char *)&peakRss, sizeof (peakRss));
+  os.write ((const char *)&endRss, sizeof (endRss));
+  os.write ((const char *)&performance, sizeof (performance));
+  // Summary holds only double values
+  os.write ((const char *)&aap, sizeof (aap));
+  os.write ((const char *)&aaf, sizeof (aaf));
+  delayHist.Serialize (os);
+}
+
+bool
+RunSummary::Deserialize (std::istream &is)
+{
+  uint32_t flows = 0;
+  is.read ((char *)&flows, sizeof (flows));
+  is.read ((char *)&peakRss, sizeof (peakRss));
+  is.read ((char *)&endRss, sizeof (endRss));
+  is.read ((char *)&performance, sizeof (performance));
+  is.read ((char *)&aap, sizeof (aap));
+  is.read ((char *)&aaf, sizeof (aaf));
+  numberOfFlows = flows;
+  return is && delayHist.Deserialize (is);
+}
+
+/*******************************************************
+ * ScalarData
+ *******************************************************/
+void
+ScalarData::RecordSent (const PacketRecord &record)
+{
+  totalTxPackets++; // number of transmitted packets
+  packetSizeInBytes = record.size; // last packet's size
+  totalTxBytes += record.size; // total bytes transmitted
+  lastPacketSent = TimeStep (record.txTimeStep);
+  if (totalTxPackets == 1) // first sent packet
+    {
+      firstPacketSent = lastPacketSent;
+    }
+}
+
+void
+ScalarData::RecordReceived (const PacketRecord &record)
+{
+  totalRxPackets++; // number of received packets
+  packetSizeInBytes = record.size; // last packet's size
+  totalRxBytes += record.size; // total bytes received
+  lastPacketReceived = TimeStep (record.rxTimeStep);
+  lastDelay = TimeStep (record.delayTimeStep);
+  if (totalRxPackets == 1) // first received packet
+    {
+      firstPacketReceived = lastPacketReceived;
+      firstDelay = lastDelay; // Warning: actual first packet sent can be lost
+    }
+  delayHist.AddValue (lastDelay.GetSeconds ());
+}
+
+/******************************************************
+ * NetFlowId
+ *******************************************************/
+// IP address and port of a flow end, "<not valid>" if it is not known
+static void
+WriteFlowAddress (std::ostream &oss, const Address &addr)
+{
+  if (InetSocketAddress::IsMatchingType (addr))
+    {
+      oss << InetSocketAddress::ConvertFrom (addr).GetIpv4 ()
+          << ":" << InetSocketAddress::ConvertFrom (addr).GetPort ();
+    }
+  else if (Inet6SocketAddress::IsMatchingType (addr))
+    {
+      oss << "[" << Inet6SocketAddress::ConvertFrom (addr).GetIpv6 ()
+          << "]:" << Inet6SocketAddress::ConvertFrom (addr).GetPort ();
+    }
+  else
+    {
+      oss << "<not valid>";
+    }    
+}
+
+void
+NetFlowId::SetSourceAddress (const Address &addr)
+{
+  if (InetSocketAddress::IsMatchingType (addr) || Inet6SocketAddress::IsMatchingType (addr))
+    {
+      sourceKey = StatsHeader::GetSinkKey (addr);
+    }
+}
+
+std::string
+NetFlowId::ToString () const
+{
+  std::ostringstream oss;
+  oss << flowIndex << ": " << sourceNodeId << "-" << sourceAppId << "( ";
+  WriteFlowAddress (oss, GetSourceAddress ());
+  oss << " ) ---> " << sinkNodeId << "-" << sinkAppId << "( ";
+  WriteFlowAddress (oss, GetSinkAddress ());
+  oss << " )";
+  return oss.str ();
+}
+
+std::string
+NetFlowId::ToCsvString () const
+{
+  std::ostringstream oss;
+  oss << flowIndex << "," << sourceNodeId << "," << sourceAppId << ",";
+  WriteFlowAddress (oss, GetSourceAddress ());
+  oss << "," << sinkNodeId << "," << sinkAppId << ",";
+  WriteFlowAddress (oss, GetSinkAddress ());
+  return oss.str ();
+}
+
+/*******************************************************
+ * FlowData
+ *******************************************************/
+FlowData::FlowData (NetFlowId fid, bool scalarFileWriteEnable,
+                    bool vectorFileWriteEnable, double histRes, uint8_t histLogLinear, bool histSparse)
+    : m_flowId (fid),
+      m_scalarData (histRes, histLogLinear, histSparse),
+      m_scalarFileWriteEnable (scalarFileWriteEnable),
+      m_vectorFileWriteEnable (vectorFileWriteEnable),
+      m_vectorFileRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+
+Summary
+FlowData::Finalize (std::ostream &out)
+{
+  NS_LOG_FUNCTION (this);
+
+  Summary s;
+  Time endOfTransmition = (m_scalarData.lastPacketSent - m_scalarData.lastPacketReceived > 0)
+                          ? (m_scalarData.lastPacketSent) : (m_scalarData.lastPacketReceived);
+  s.duration = (endOfTransmition - m_scalarData.firstPacketSent).GetSeconds ();
+  if (s.duration > 0)
+    {
+      s.throughput = 8.0 * (double)m_scalarData.totalRxBytes / s.duration;
+    }
+  else
+    {
+      s.throughput = 0.0;
+    }
+  s.txPackets = m_scalarData.totalTxPackets;
+  s.rxPackets = m_scalarData.totalRxPackets;
+  s.lostPackets = m_scalarData.totalTxPackets - m_scalarData.totalRxPackets;
+  s.lostRatio = 100*s.lostPackets/s.txPackets;
+  s.e2eDelayMin = m_scalarData.delayHist.GetMin ();
+  s.e2eDelayMax = m_scalarData.delayHist.GetMax ();
+  s.e2eDelayAverage = m_scalarData.delayHist.GetMean ();
+  s.e2eDelayMedianEstinate = m_scalarData.delayHist.GetMedianEstimation ();
+  s.e2eDelayJitter = m_scalarData.delayHist.GetStdDev ();
+  s.e2eDelayP90 = m_scalarData.delayHist.GetQuantile (0.9);
+  s.e2eDelayP95 = m_scalarData.delayHist.GetQuantile (0.95);
+  s.e2eDelayP99 = m_scalarData.delayHist.GetQuantile (0.99);
+  s.e2eDelayP999 = m_scalarData.delayHist.GetQuantile (0.999);
+
+  if (IsScalarFileWriteEnabled ())
+  {
+    out << std::endl;
+    out << "Flow Index, Source Node, Source App, Source Address, Sink Node, Sink App, Sink Address" << std::endl;
+    out << m_flowId.ToCsvString () << std::endl;
+    out << "Number of Rx packets for flow:," << s.rxPackets
+        << ", written to file:, " << m_vectorFileRecords // records dropped by the vector file (DROP policy) are not counted
+        << ", written to hist:, " << m_scalarData.delayHist.GetCount ()
+        << std::endl;
+    out << std::endl;
+    out << "Last packet length [B]:,"  << m_scalarData.packetSizeInBytes << std::endl;
+    out << "Transmission duration [s]:,"  << s.duration << std::endl;
+    out << "Throughput [bps]:," << s.throughput << std::endl;
+    out << "Tx packets:," << s.txPackets << std::endl;
+    out << "Rx packets:," << s.rxPackets << std::endl;
+    out << "Lost packets:," << s.lostPackets << std::endl;
+    out << "Lost packet ratio [%]:," << s.lostRatio << std::endl;
+    out << "E2E delay - Min [ms]," << 1000.0*s.e2eDelayMin << std::endl;
+    out << "E2E delay - Max [ms]," << 1000.0*s.e2eDelayMax << std::endl;
+    out << "E2E delay - Average [ms]," << 1000.0*s.e2eDelayAverage << std::endl;
+    out << "E2E delay - Median estimate (+/-" << 1000.0 * 0.5 *m_scalarData.delayHist.GetResolution (s.e2eDelayMedianEstinate) << ") [ms]:," << 1000.0*s.e2eDelayMedianEstinate << std::endl;
+    out << "E2E delay - Jitter [ms]," << 1000.0*s.e2eDelayJitter << std::endl;
+    out << "E2E delay - 90th percentile [ms]," << 1000.0*s.e2eDelayP90 << std::endl;
+    out << "E2E delay - 95th percentile [ms]," << 1000.0*s.e2eDelayP95 << std::endl;
+    out << "E2E delay - 99th percentile [ms]," << 1000.0*s.e2eDelayP99 << std::endl;
+    out << "E2E delay - 99.9th percentile [ms]," << 1000.0*s.e2eDelayP999 << std::endl;
+    out << std::endl;
+    out << "Rx," << "First packet [us]:," << m_scalarData.firstPacketReceived.GetMicroSeconds () << std::endl;
+    out << "Rx,"<< "Last packet [us]:," << m_scalarData.lastPacketReceived.GetMicroSeconds () << std::endl;
+    Time diffRx = m_scalarData.lastPacketReceived - m_scalarData.firstPacketReceived;
+    out << "Rx,"<< "Receiving duration [s]:,"  << diffRx.GetSeconds () << std::endl;
+    out << "Rx,"<< "Count of packets:,"  << m_scalarData.totalRxPackets << std::endl;
+    out << "Rx,"<< "Total bytes:,"  << m_scalarData.totalRxBytes << std::endl;
+    if (diffRx.GetSeconds ())
+      {
+        out << "Rx,"<< "Throughput [bps]:,"  << 8.0 * (double)m_scalarData.totalRxBytes / diffRx.GetSeconds () << std::endl;
+      }
+    else
+      {
+        out << "Rx,"<< "Throughput [bps]:,"  << 0.0 << std::endl;
+      }
+    out << std::endl;
+    out << "Tx," << "First packet [us]:," << m_scalarData.firstPacketSent.GetMicroSeconds () << std::endl;
+    out << "Tx,"<< "Last packet [us]:," << m_scalarData.lastPacketSent.GetMicroSeconds () << std::endl;
+    Time diffTx = m_scalarData.lastPacketSent - m_scalarData.firstPacketSent;
+    out << "Tx,"<< "Sending duration [s]:,"  << diffTx.GetSeconds () << std::endl;
+    out << "Tx,"<< "Count of packets:,"  << m_scalarData.totalTxPackets << std::endl;
+    out << "Tx,"<< "Total bytes:,"  << (m_scalarData.totalTxBytes) << std::endl;
+    if (diffTx.GetSeconds ())
+      {
+        out << "Tx,"<< "Throughput [bps]:,"  << 8.0 * (double)(m_scalarData.totalTxBytes) / diffTx.GetSeconds () << std::endl;
+      }
+    else
+      {
+        out << "Tx,"<< "Throughput [bps]:,"  << 0.0 << std::endl;
+      }
+    out << std::endl;
+  }
+  return s;
+}
+
+/******************************************************
+ * StatsFlows
+ *******************************************************/
+namespace {
+
+// Time of an empty measurement (two steady_clock reads), subtracted from the measured callbacks
+double
+GetClockOverhead ()
+{
+  static double overhead = -1;
+  if (overhead < 0)
+    {
+      std::vector<double> samples (1001);
+      for (uint32_t i = 0; i < samples.size (); ++i)
+        {
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+          samples[i] = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+        }
+      std::nth_element (samples.begin (), samples.begin () + samples.size () / 2, samples.end ());
+      overhead = samples[samples.size () / 2];
+    }
+  return overhead;
+}
+
+// Counts one packet callback and times every 64th of them (two clock reads per
+// callback would cost about as much as the callback itself), the time is scaled by 64
+class SampledCallbackTimer
+{
+public:
+  SampledCallbackTimer (RunPerformance &performance)
+    : m_performance (performance),
+      m_timed ((++performance.statsCallbacks & 63) == 0)
+  {
+    if (m_timed)
+      {
+        m_start = std::chrono::steady_clock::now ();
+      }
+  }
+  ~SampledCallbackTimer ()
+  {
+    if (m_timed)
+      {
+        double time = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_start).count () - GetClockOverhead ();
+        m_performance.statsCallbackTime += time > 0 ? 64 * time : 0.0;
+      }
+  }
+private:
+  RunPerformance &m_performance;
+  bool m_timed;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // anonymous namespace
+
+StatsFlows::StatsFlows (uint64_t rngRun, std::string fn, bool scalarFileWriteEnable, bool vectorFileWriteEnable,
+                        StatsVectorFile::Format vectorFileFormat) :
+    m_rngRun (rngRun),
+    m_fileName (fn + "-Run_" + std::to_string (rngRun)),
+    m_scalarFileWriteEnable (scalarFileWriteEnable),
+    m_vectorFileWriteEnable (vectorFileWriteEnable),
+    m_histogramResolution (0.0001), // 0.1 ms
+    m_histogramLogLinear (0), // fixed width bins
+    m_histogramSparse (true) // per-flow histograms store only occupied bins
+{ 
+  m_vectorFile.SetFormat (vectorFileFormat);
+  ConnectTraces ();
+  StartPerformance ();
+}
+
+void
+StatsFlows::StartRun (uint64_t rngRun, std::string fn)
+{
+  NS_LOG_FUNCTION (this << rngRun << fn);
+  // Finalize () cleared the flows of the previous run
+  NS_ASSERT_MSG (m_flowData.empty (), "Finalize () the previous run before StartRun ().");
+  m_rngRun = rngRun;
+  m_fileName = fn + "-Run_" + std::to_string (rngRun);
+  m_overhead.Clear (); // devices of the previous run are destroyed
+  ConnectTraces ();
+  StartPerformance ();
+}
+
+void
+StatsFlows::StartPerformance ()
+{
+  m_performance = RunPerformance ();
+  GetClockOverhead (); // calibrated once, before the first callback
+  STATS_PROFILE (m_profile.Clear ());
+  m_wallClockStart = std::chrono::steady_clock::now ();
+  m_eventsStart = Simulator::GetEventCount ();
+}
+
+void
+StatsFlows::ConnectTraces ()
+{
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t a = 0; a < (*node)->GetNApplications (); ++a)
+        {
+          ConnectApplication ((*node)->GetApplication (a));
+        }
+    }
+  // every device will have PHY callback for tracing
+  // which is used to determine the total amount of
+  // data transmitted, and then used to calculate
+  // the MAC/PHY overhead beyond the app-data
+  m_overhead.AttachAll ("PhyTxBegin");
+}
+
+void
+StatsFlows::ConnectApplication (Ptr<Application> app)
+{
+  // Trace sources are recognized by their callback signature, so that the trace
+  // sources of other applications with the same name (e.g. OnOffApplication "Tx",
+  // packets without StatsHeader) are not connected
+  TypeId tid = app->GetInstanceTypeId ();
+  struct TypeId::TraceSourceInformation info;
+  // decoded header fields, no packet or address copies per packet; the packet
+  // based trace source of the same application is not connected (no duplicates)
+  if (tid.LookupTraceSourceByName ("TxRecord", &info) && info.callback == "ns3::StatsPacketSource::RecordTracedCallback")
+    {
+      app->TraceConnectWithoutContext ("TxRecord", MakeCallback (&StatsFlows::TxRecord, this));
+    }
+  else if (tid.LookupTraceSourceByName ("Tx", &info) && info.callback == "ns3::StatsPacketSource::TxTracedCallback")
+    {
+      NS_LOG_INFO ("Application " << tid.GetName () << " has no TxRecord, packet based Tx connected");
+      app->TraceConnectWithoutContext ("Tx", MakeCallback (&StatsFlows::PacketSent, this));
+    }
+  if (tid.LookupTraceSourceByName ("RxRecord", &info) && info.callback == "ns3::StatsPacketSink::RecordTracedCallback")
+    {
+      app->TraceConnectWithoutContext ("RxRecord", MakeCallback (&StatsFlows::RxRecord, this));
+    }
+  else if (tid.LookupTraceSourceByName ("Rx", &info) && info.callback == "ns3::StatsPacketSink::StatsTracedCallback")
+    {
+      NS_LOG_INFO ("Application " << tid.GetName () << " has no RxRecord, packet based Rx connected");
+      app->TraceConnectWithoutContext ("Rx", MakeCallback (&StatsFlows::PacketReceived, this));
+    }
+}
+
+void
+StatsFlows::PacketSent (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this);
+  StatsHeader statsHeader;
+  packet->PeekHeader (statsHeader);
+  StatsPacketInfo info;
+  statsHeader.GetPacketInfo (info);
+  info.size = packet->GetSize ();
+  TxRecord (info);
+}
+
+void
+StatsFlows::PacketReceived (Ptr<const Packet> packet, uint32_t sinkNodeId, uint32_t sinkAppId, Address sourceAddr)
+{
+  NS_LOG_FUNCTION (this);
+  StatsHeader statsHeader;
+  packet->PeekHeader (statsHeader);
+  StatsPacketInfo info;
+  statsHeader.GetPacketInfo (info);
+  info.size = packet->GetSize ();
+  RxRecord (info, sinkNodeId, sinkAppId, sourceAddr);
+}
+
+void
+StatsFlows::TxRecord (const StatsPacketInfo &info)
+{
+  NS_LOG_FUNCTION (this);
+  SampledCallbackTimer timer (m_performance);
+  STATS_PROFILE_SCOPE (m_profile, TX_RECORD);
+
+  PacketRecord record;
+  record.txTimeStep = info.txTimeStep;
+  record.rxTimeStep = 0;
+  record.delayTimeStep = 0;
+  record.seq = info.seq;
+  record.size = info.size;
+
+  // All runs scalar statistics
+  m_allPacketsStats.RecordSent (record);
+  NS_LOG_INFO ("Packet sent: " << m_allPacketsStats.totalTxPackets);
+
+  // Search for existing FlowIds
+  NetFlowKey key (info.sourceNodeId, info.sourceAppId, info.sinkKey);
+  uint32_t i = FindFlow (info, key);
+  if (i == m_flowData.size ()) // not found -> new FlowId
+  {
+    NS_ASSERT_MSG (m_flowData.size () < std::numeric_limits<uint32_t>::max (), "Too many flows, flow index is 32-bit.");
+    i = m_flowData.size ();
+    NetFlowId fid (info.sourceNodeId, info.sourceAppId, info.sinkKey);
+    fid.flowIndex = i;
+    FlowData fd (fid, m_scalarFileWriteEnable, m_vectorFileWriteEnable, m_histogramResolution, m_histogramLogLinear, m_histogramSparse);
+    m_flowData.push_back (fd);
+    m_flowIndex.insert (std::make_pair (key, i));
+    BindFlowSlot (info.flowSlot, i);
+    NS_LOG_INFO ("New flow [size=" << m_flowData.size () << "]: " << m_flowData[i].GetFlowId ().ToString ());
+  }
+  else // found existing FlowId
+  {
+    NS_LOG_INFO ("Flow found: [size=" << m_flowData.size () << "]: " << m_flowData[i].GetFlowId ().ToString ());
+  }
+  
+  m_flowData[i].PacketSent (record); // call apps statistics calculations for this particular FlowId
+}
+
+void
+StatsFlows::RxRecord (const StatsPacketInfo &info, uint32_t sinkNodeId, uint32_t sinkAppId, const Address &sourceAddr)
+{
+  NS_LOG_FUNCTION (this);
+  SampledCallbackTimer timer (m_performance);
+  STATS_PROFILE_SCOPE (m_profile, RX_RECORD);
+
+  PacketRecord record;
+  record.txTimeStep = info.txTimeStep;
+  record.rxTimeStep = Simulator::Now ().GetTimeStep ();
+  record.delayTimeStep = record.rxTimeStep - record.txTimeStep;
+  record.seq = info.seq;
+  record.size = info.size;
+
+  // Scalar data for all runs
+  m_allPacketsStats.RecordReceived (record);
+  NS_LOG_INFO ("Packet received: " << m_allPacketsStats.totalRxPackets);
+
+  // If this is the first packet received at all, create vector file and write file header
+  if (IsVectorFileWriteEnabled () && !m_vectorFile.IsOpen ())
+    {
+      m_vectorFile.Open (m_fileName + "-vec" + m_vectorFile.GetFileExtension (), "Delay [us]");
+    }
+
+  // Search for existing FlowIds
+  NetFlowKey key (info.sourceNodeId, info.sourceAppId, info.sinkKey);
+  uint32_t i = FindFlow (info, key);
+  if (i == m_flowData.size ()) // not found in existing FlowIds
+  {
+    NS_LOG_INFO (">>>>>>>>>>>>>>  New Flow, not possible, assert!!! >>>>>>>>>>>>>>>>>>>>>");
+    NS_LOG_INFO ("Existing flows:");
+    for (i = 0; i < m_flowData.size(); i++)
+    {
+       NS_LOG_INFO (m_flowData[i].GetFlowId ().ToString ());
+    }
+    NS_LOG_INFO ("New Flow: [size=" << m_flowData.size () << "]: "
+                 << NetFlowId (info.sourceNodeId, info.sourceAppId, info.sinkKey, sinkNodeId, sinkAppId).ToString ());
+    NS_ASSERT_MSG (0, "New Flow, not possible, assert!!!");
+    return;
+  }
+  else // Flow exists
+  {
+    if (m_flowData[i].IsFirstPacketReceived ())
+      {
+        m_flowData[i].GetFlowId ().sinkNodeId = sinkNodeId;
+        m_flowData[i].GetFlowId ().sinkAppId = sinkAppId;
+        m_flowData[i].GetFlowId ().SetSourceAddress (sourceAddr);
+      }
+    NS_LOG_INFO ("Flow found: [size=" << m_flowData.size () << "]: " << m_flowData[i].GetFlowId ().ToString ());      
+  }
+  
+  STATS_PROFILE (uint32_t histMemory = m_flowData[i].GetDelayHist ().GetMemoryUsage ());
+  {
+    STATS_PROFILE_SCOPE (m_profile, FLOW_PACKET_RECEIVED);
+    m_flowData[i].PacketReceived (record); // call statistics calculations for this particular FlowId
+  }
+  STATS_PROFILE_COUNT (m_profile, HIST_RESIZES, m_flowData[i].GetDelayHist ().GetMemoryUsage () != histMemory);
+
+  // vector data
+  if (IsVectorFileWriteEnabled ())
+    {
+      if (m_vectorFile.Write (m_allPacketsStats.lastPacketReceived, m_flowData[i].GetFlowId ().flowIndex,
+                              record.seq, m_allPacketsStats.lastDelay))
+        {
+          m_flowData[i].VectorFileRecordWritten ();
+        }
+    }
+}
+
+uint64_t
+StatsFlows::GetFlowMemoryUsage () const
+{
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < m_flowData.size (); ++i)
+    {
+      bytes += m_flowData[i].GetMemoryUsage ();
+    }
+  // reserved but unused records
+  return bytes + (m_flowData.capacity () - m_flowData.size ()) * sizeof (FlowData);
+}
+
+uint32_t
+StatsFlows::FindFlow (const StatsPacketInfo &info, const NetFlowKey &key)
+{
+  // bound flow: direct index
+  if (info.flowSlot < m_slotIndex.size () && m_slotIndex[info.flowSlot] != StatsPacketInfo::NO_FLOW_SLOT)
+    {
+      STATS_PROFILE_COUNT (m_profile, SLOT_LOOKUPS, 1);
+      return m_slotIndex[info.flowSlot];
+    }
+  STATS_PROFILE_COUNT (m_profile, HASH_LOOKUPS, 1);
+  STATS_PROFILE_COUNT (m_profile, HASH_PROBES, m_flowIndex.empty () ? 0 : m_flowIndex.bucket_size (m_flowIndex.bucket (key)));
+  std::unordered_map<NetFlowKey, uint32_t, NetFlowKeyHash>::iterator it = m_flowIndex.find (key);
+  if (it == m_flowIndex.end ())
+    {
+      return m_flowData.size ();
+    }
+  BindFlowSlot (info.flowSlot, it->second);
+  return it->second;
+}
+
+void
+StatsFlows::BindFlowSlot (uint32_t flowSlot, uint32_t i)
+{
+  if (flowSlot == StatsPacketInfo::NO_FLOW_SLOT)
+    {
+      return;
+    }
+  if (flowSlot >= m_slotIndex.size ())
+    {
+      m_slotIndex.resize (flowSlot + 1, StatsPacketInfo::NO_FLOW_SLOT);
+    }
+  m_slotIndex[flowSlot] = i;
+}
+
+RunSummary
+StatsFlows::Finalize ()
+{
+  NS_LOG_FUNCTION (this);
+  
+  RunSummary srs;
+  srs.numberOfFlows = m_flowData.size();
+
+  // Write remaining buffered vector records
+  m_vectorFile.Close ();
+
+  // All packets average summary
+  Time endOfTransmition = (m_allPacketsStats.lastPacketSent - m_allPacketsStats.lastPacketReceived > 0)
+                          ? (m_allPacketsStats.lastPacketSent) : (m_allPacketsStats.lastPacketReceived);
+  srs.aap.duration = (endOfTransmition - m_allPacketsStats.firstPacketSent).GetSeconds ();
+  srs.aap.throughput = (double)m_allPacketsStats.totalRxBytes * 8.0 / srs.aap.duration;
+  srs.aap.txPackets = m_allPacketsStats.totalTxPackets;
+  srs.aap.rxPackets = m_allPacketsStats.totalRxPackets;
+  srs.aap.lostPackets = m_allPacketsStats.totalTxPackets - m_allPacketsStats.totalRxPackets;
+  srs.aap.lostRatio = 100.0* (double)srs.aap.lostPackets / (double)srs.aap.txPackets;
+  // PHY values are known only when device Tx trace sources are attached
+  bool phyTxCounted = m_overhead.GetNDevices () > 0;
+  if (!phyTxCounted)
+    {
+      NS_LOG_WARN ("No device Tx trace source is attached (no \"PhyTxBegin\", e.g. Wi-Fi), PHY Tx packets and PHY over APP traffic ratio are not available; attach the devices with GetOverheadCollector ()");
+    }
+  m_allPacketsStats.phyTxPkts += m_overhead.GetTxPackets ();
+  m_allPacketsStats.phyTxBytes += m_overhead.GetTxBytes ();
+  srs.aap.phyTxPkts = m_allPacketsStats.phyTxPkts;
+  srs.aap.usefullNetTraffic = m_overhead.GetPhyOverAppRatio (m_allPacketsStats.totalTxBytes);
+  srs.aap.e2eDelayMin = m_allPacketsStats.delayHist.GetMin ();
+  srs.aap.e2eDelayMax = m_allPacketsStats.delayHist.GetMax ();
+  srs.aap.e2eDelayAverage = m_allPacketsStats.delayHist.GetMean ();
+  srs.aap.e2eDelayMedianEstinate = m_allPacketsStats.delayHist.GetMedianEstimation ();
+  srs.aap.e2eDelayJitter = m_allPacketsStats.delayHist.GetStdDev ();
+  srs.aap.e2eDelayP90 = m_allPacketsStats.delayHist.GetQuantile (0.9);
+  srs.aap.e2eDelayP95 = m_allPacketsStats.delayHist.GetQuantile (0.95);
+  srs.aap.e2eDelayP99 = m_allPacketsStats.delayHist.GetQuantile (0.99);
+  srs.aap.e2eDelayP999 = m_allPacketsStats.delayHist.GetQuantile (0.999);
+  srs.delayHist = m_allPacketsStats.delayHist;
+
+  // Performance of the run
+  srs.performance = m_performance;
+  srs.performance.wallClockTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_wallClockStart).count ();
+  srs.performance.simulatedTime = Simulator::Now ().GetSeconds ();
+  srs.performance.events = Simulator::GetEventCount () - m_eventsStart;
+  srs.performance.statsCallbacks += m_overhead.GetTxPackets (); // one callback per device transmission
+  srs.peakRss = StatsMemory::GetPeakRss ();
+
+  // Scalar file is opened once for all flows (delete old file if it exists)
+  std::ofstream out;
+  if (IsScalarFileWriteEnabled ())
+    {
+      out.open ((m_fileName + "-sca.csv").c_str (), std::ofstream::out | std::ofstream::trunc);
+    }
+
+  // All flows average summary
+  for (uint32_t i = 0; i < srs.numberOfFlows; i++)
+    {
+      NS_LOG_INFO ("FINALIZE: call Finalize() for flowId=" << i);
+      // Calculates all flows average and also writes flow summary to scalar file if enabled
+      srs.aaf.IterativeAdd(m_flowData[i].Finalize (out), i+1);
+    }
+
+  if (IsScalarFileWriteEnabled ())
+    {
+      out << std::endl;
+      out << "AVERAGE RESULTS, Average of all flows (" << srs.numberOfFlows << "), Average of all packets" << std::endl;
+      out << "Transmission duration [s]:," << srs.aaf.duration << "," << srs.aap.duration << std::endl;
+      out << "Throughput [bps]:," << srs.aaf.throughput << "," << srs.aap.throughput << std::endl;
+      out << "Tx packets:," << srs.aaf.txPackets << "," << srs.aap.txPackets << std::endl;
+      out << "Rx packets:," << srs.aaf.rxPackets << "," << srs.aap.rxPackets << std::endl;
+      out << "Lost packets:," << srs.aaf.lostPackets << "," << srs.aap.lostPackets << std::endl;
+      out << "Lost packet ratio [%]:," << srs.aaf.lostRatio << "," << srs.aap.lostRatio << std::endl;
+      if (phyTxCounted)
+        {
+          out << "PHY Tx packets:," << "," << srs.aap.phyTxPkts << std::endl;
+          out << "PHY over APP traffic ratio [%]:," << "," << srs.aap.usefullNetTraffic << std::endl;
+        }
+      else
+        {
+          out << "PHY Tx packets:," << "," << "n/a" << std::endl;
+          out << "PHY over APP traffic ratio [%]:," << "," << "n/a" << std::endl;
+        }
+      out << "E2E delay - Min [ms]:," << 1000.0*srs.aaf.e2eDelayMin << "," << 1000.0*srs.aap.e2eDelayMin << std::endl;
+      out << "E2E delay - Max [ms]:," << 1000.0*srs.aaf.e2eDelayMax << "," << 1000.0*srs.aap.e2eDelayMax << std::endl;
+      out << "E2E delay - Average [ms]:," << 1000.0*srs.aaf.e2eDelayAverage << "," << 1000.0*srs.aap.e2eDelayAverage << std::endl;
+      out << "E2E delay - Median estimate (+/-" << 1000.0 * 0.5 *m_allPacketsStats.delayHist.GetResolution (srs.aap.e2eDelayMedianEstinate) << ") [ms]:," << 1000.0*srs.aaf.e2eDelayMedianEstinate << "," << 1000.0*srs.aap.e2eDelayMedianEstinate << std::endl;
+      out << "E2E delay - Jitter [ms]:," << 1000.0*srs.aaf.e2eDelayJitter << "," << 1000.0*srs.aap.e2eDelayJitter << std::endl;
+      out << "E2E delay - 90th percentile [ms]:," << 1000.0*srs.aaf.e2eDelayP90 << "," << 1000.0*srs.aap.e2eDelayP90 << std::endl;
+      out << "E2E delay - 95th percentile [ms]:," << 1000.0*srs.aaf.e2eDelayP95 << "," << 1000.0*srs.aap.e2eDelayP95 << std::endl;
+      out << "E2E delay - 99th percentile [ms]:," << 1000.0*srs.aaf.e2eDelayP99 << "," << 1000.0*srs.aap.e2eDelayP99 << std::endl;
+      out << "E2E delay - 99.9th percentile [ms]:," << 1000.0*srs.aaf.e2eDelayP999 << "," << 1000.0*srs.aap.e2eDelayP999 << std::endl;
+      if (IsVectorFileWriteEnabled ())
+        {
+          out << "Vector file records:," << "," << m_vectorFile.GetNRecords () << std::endl;
+          if (m_vectorFile.IsAsync ())
+            {
+              out << "Vector file records dropped (queue full):," << "," << m_vectorFile.GetNDropped () << std::endl;
+              out << "Vector file records blocked (queue full):," << "," << m_vectorFile.GetNBlocked () << std::endl;
+            }
+        }
+      out << std::endl;
+      out << "PERFORMANCE" << std::endl;
+      out << "Wall-clock time [s]:," << "," << srs.performance.wallClockTime << std::endl;
+      out << "Simulated time over wall-clock time:," << "," << srs.performance.GetSimulatedOverWallClock () << std::endl;
+      out << "Simulator events:," << "," << srs.performance.events << std::endl;
+      out << "Simulator events per second:," << "," << srs.performance.GetEventsPerSecond () << std::endl;
+      out << "Stats callbacks:," << "," << srs.performance.statsCallbacks << std::endl;
+      out << "Time in stats callbacks [s]:," << "," << srs.performance.statsCallbackTime << std::endl;
+      out << "Peak RSS [MB]:," << "," << srs.peakRss / 1048576.0 << std::endl;
+      if (m_overhead.GetNDevices () > 0)
+        {
+          out << std::endl;
+          out << "PHY Tx per node, Tx packets, Tx bytes" << std::endl;
+          m_overhead.WritePerNode (out);
+        }
+      out << std::endl;
+      out.close ();
+      m_allPacketsStats.delayHist.WriteToCsvFile (m_fileName + "-sca.csv", 0.0001, "E2E Delay Hist:");
+    }
+#ifdef STATS_PROFILING
+  // cost breakdown of the packet callbacks: end of the scalar file, or standard output
+  if (IsScalarFileWriteEnabled ())
+    {
+      std::ofstream profileOut ((m_fileName + "-sca.csv").c_str (), std::ofstream::out | std::ofstream::app);
+      profileOut << std::endl;
+      m_profile.Write (profileOut, m_overhead.GetTxPackets (), m_vectorFile.GetNBytesWritten ());
+    }
+  else
+    {
+      m_profile.Write (std::cout, m_overhead.GetTxPackets (), m_vectorFile.GetNBytesWritten ());
+    }
+#endif
+  Clear ();
+  return srs;
+}
+
+void
+StatsFlows::Clear ()
+{
+  m_allPacketsStats.Clear ();
+  for (uint32_t i = 0; i < m_flowData.size(); i++)
+    {
+      m_flowData[i].Clear ();
+    }
+  m_flowData.clear ();
+  m_flowIndex.clear ();
+  m_slotIndex.clear ();
+  m_overhead.Reset (); // devices stay attached
+  m_vectorFile.Close ();
+}
+
+
+} // namespace ns3
@@ -1,308 +1,466 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
-/*
- * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the GNU General Public License version 2 as
- * published by the Free Software Foundation;
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program; if not, write to the Free Software
- * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
- *
- * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
- *                       <nen.jevtic@gmail.com>
- *          Marija Malnar <m.malnar@sf.bg.ac.rs>
- */
-
-#ifndef STATS_DATA_H
-#define STATS_DATA_H
-
-#include <string>
-#include <vector>
-#include <fstream>
-#include <utility> // std::pair
-
-#include "ns3/nstime.h"
-#include "ns3/ptr.h"
-#include "ns3/packet.h"
-#include "ns3/address.h"
-#include "ns3/inet-socket-address.h"
-#include "ns3/inet6-socket-address.h"
-#include "ns3/stats-hist.h"
-#include "ns3/log.h"
-#include "ns3/wifi-mode.h"
-#include "ns3/wifi-preamble.h"
-
-namespace ns3 {
-  
-
-/*******************************************************
- * Summary & RunSummary
- *******************************************************/
-struct Summary
-{
-	Summary ():
-		duration (0),
-		throughput (0),
-		txPackets (0),
-		rxPackets (0),
-		lostPackets (0),
-		lostRatio (0),
-		phyTxPkts (0),
-		usefullNetTraffic (0),
-		e2eDelayMin (0),
-		e2eDelayMax (0),
-		e2eDelayAverage (0),
-		e2eDelayMedianEstinate (0),
-		e2eDelayJitter (0)
-	{};
-	void IterativeAdd (const Summary &s, unsigned iteration);
-
-	double duration;
-	double throughput;
-	double txPackets;
-	double rxPackets;
-	double lostPackets;
-	double lostRatio;
-  double phyTxPkts;
-  double usefullNetTraffic;
-	double e2eDelayMin;
-	double e2eDelayMax;
-	double e2eDelayAverage;
-	double e2eDelayMedianEstinate;
-	double e2eDelayJitter;
-};
-
-struct RunSummary
-{
-	RunSummary () :
-		numberOfFlows (0)
-	{};
-
-	unsigned int numberOfFlows;
-	Summary aap; // All packets summary
-	Summary aaf; // All flows summary
-};
-
-/*******************************************************
- * ScalarData
- *******************************************************/
-struct ScalarData
-{
-  ScalarData (double histRes = 0.0001) 
-    : totalRxPackets (0),
-	    totalTxPackets (0),
-	    totalRxBytes (0),
-	    totalTxBytes (0),
-	    phyTxPkts (0),
-	    phyTxBytes (0),
-	    delayHist (histRes)  // 0.1 ms, default
-  {
-    delayHist.Clear ();
-  }
-
-  void Clear ()
-  {
-    totalRxPackets = 0;
-    totalTxPackets = 0;
-	  totalRxBytes = 0;
-	  totalTxBytes = 0;
-    phyTxPkts = 0;
-    phyTxBytes = 0;
-	  delayHist.Clear ();
-  }
-
-  uint32_t totalRxPackets; // number of total application packets receiced
-  uint32_t totalTxPackets; // number of total application packets sent
-  uint64_t totalRxBytes;   // total received application bytes
-  uint64_t totalTxBytes;   // total transmitted application bytes
-  uint16_t packetSizeInBytes;
-  uint16_t phyTxPkts; // number of phy packets sent
-  uint64_t phyTxBytes; // phy bytes sent
-  Time firstPacketSent, lastPacketSent;
-  Time firstPacketReceived, lastPacketReceived;
-  Time firstDelay, lastDelay;
-  StatsHist delayHist;
-};
-
-/*******************************************************
- * VectorData
- *******************************************************/
-template<class T>
-class VectorData
-{
-public:
-  VectorData (std::string name = "Delay [us]")
-    : m_name (name),
-      m_numValuesWrittenToFile (0)
-  {};
-  void WriteValueToFile (std::string fileName, Time time, T t, uint16_t flowIndex = 0, uint32_t seqNo = 0);
-  void WriteFileHeader (std::string fileName);
-  int GetNValuesWrittenToFile () {return m_numValuesWrittenToFile; };
-  void Clear () { m_numValuesWrittenToFile = 0; };
-private:
-  std::string m_name;
-  int m_numValuesWrittenToFile;
-};
-
-template<class T>
-void VectorData<T>::WriteValueToFile (std::string fileName, Time time, T t, uint16_t flowIndex, uint32_t seqNo)
-{
-  std::ofstream out;
-  out.open (fileName.c_str (), std::ofstream::out | std::ofstream::app);
-  out << flowIndex << ",";
-  out << time.GetDouble () / 1000.0 << ",";
-  out << seqNo << ",";
-  
-  for (int i=0; i < flowIndex; ++i)
-    {
-      out << ",";
-    }
-  
-  Time *tp = dynamic_cast<Time*> (&t);
-  if (tp != 0)
-  { // if T is actually Time print time in micro seconds
-    out << t.GetDouble () / 1000.0 << std::endl;  
-  }
-  else // class T must have defined operator<<
-  {
-    out << t << std::endl; 
-  }
-  out.close ();
-  m_numValuesWrittenToFile++;
-}
-
-template<class T>
-void VectorData<T>::WriteFileHeader (std::string fileName)
-{
-  std::ofstream out;
-  out.open (fileName.c_str (), std::ofstream::out | std::ofstream::trunc);
-  out << "Flow Index, Time [us], Sequence Id, " << m_name << std::endl;
-  out.close ();
-}
-
-/*******************************************************
- * NetFlowId
- *******************************************************/
-class NetFlowId
-{
-public:
-  NetFlowId (uint32_t sonid, uint32_t soaid, Address siaddr, 
-             uint32_t sinid = 0, uint32_t siaid = 0, Address soaddr = Address (), uint16_t i = 0) 
-    : sourceNodeId (sonid),
-      sourceAppId (soaid),
-      sinkAddr (siaddr),
-      sinkNodeId (sinid),
-      sinkAppId (siaid),
-      sourceAddr (soaddr),
-      flowIndex (i)
-  {};
-  
-  std::string ToString ();
-  std::string ToCsvString ();
-  
-  friend bool operator== (NetFlowId f1, NetFlowId f2);
-  uint32_t sourceNodeId;
-  uint32_t sourceAppId;
-  Address sinkAddr;
-  uint32_t sinkNodeId;
-  uint32_t sinkAppId;
-  Address sourceAddr;
-  uint16_t flowIndex;
-};
-
-inline bool 
-operator== (NetFlowId f1, NetFlowId f2) 
-{
-  bool b=0; 
-  if ( (InetSocketAddress::IsMatchingType (f1.sinkAddr) || Inet6SocketAddress::IsMatchingType (f1.sinkAddr)) &&
-       (InetSocketAddress::IsMatchingType (f2.sinkAddr) || Inet6SocketAddress::IsMatchingType (f2.sinkAddr)) )
-    {
-      b = (f1.sourceNodeId==f2.sourceNodeId) && (f1.sourceAppId==f2.sourceAppId) && (f1.sinkAddr==f2.sinkAddr);
-    }
-  else
-    {
-      NS_ASSERT_MSG (0, "Flow not valid!!! Not valid sink IP address.");
-    }    
-  return b;    
-}
-
-/*******************************************************
- * FlowData
- *******************************************************/
-class FlowData
-{
-public:
-  FlowData (NetFlowId fid, std::string fn, bool scalarFileWriteEnable = false, bool vectorFileWriteEnable = false,
-            double histRes = 0.0001);
-
-  void PacketReceived (Ptr<const Packet> packet);
-  void PacketSent (Ptr<const Packet> packet);
-  
-//  void SetFileName (std::string fileName) { m_fileName = fileName; };
-
-//  void SetScalarFileWriteEnable (bool b) { m_scalarFileWriteEnable = b; };
-  bool IsScalarFileWriteEnabled () { return m_scalarFileWriteEnable; } ;
-
-//  void SetVectorFileWriteEnable (bool b) { m_vectorFileWriteEnable = b; };
-  bool IsVectorFileWriteEnabled () { return m_vectorFileWriteEnable; } ;
-
-  Summary Finalize (); // Final calculations and write to file
-  NetFlowId& GetFlowId () { return m_flowId; };
-  bool IsFirstPacketReceived () { return m_scalarData.totalRxPackets == 0; };
-
-  void Clear () { m_scalarData.Clear (); m_delayVector.Clear (); };
-private:
-  NetFlowId m_flowId;
-  std::string m_fileName;
-  ScalarData m_scalarData;
-  VectorData<Time> m_delayVector;
-  bool m_scalarFileWriteEnable;
-  bool m_vectorFileWriteEnable;
-};
-
-/*******************************************************
- * StatsFlows
- *******************************************************/
-class StatsFlows
-{
-public:
-  StatsFlows (uint64_t rngRun, std::string fn = "noname", bool scalarFileWriteEnable = false, bool vectorFileWriteEnable = false);
-  void PacketReceived (Ptr<const Packet> packet, uint32_t sinkNodeId, uint32_t sinkAppId, Address sourceAddr);
-  void PacketSent (Ptr<const Packet> packet);
-  void PhyPacketSent (std::string context, Ptr<const Packet> packet, WifiMode mode, WifiPreamble preamble, uint8_t txPower);
-
-  RunSummary Finalize ();
-
-  void SetFileName (std::string fileName) { m_fileName = fileName; };
-
-  void SetHistResolution (double res) { m_histogramResolution = res; };
-  double GetHistResolution () { return m_histogramResolution; };
-
-  void SetScalarFileWriteEnable (bool b) { m_scalarFileWriteEnable = b; };
-  bool IsScalarFileWriteEnabled () { return m_scalarFileWriteEnable; } ;
-
-  void SetVectorFileWriteEnable (bool b) { m_vectorFileWriteEnable = b; };
-  bool IsVectorFileWriteEnabled () { return m_vectorFileWriteEnable; } ;
-
-  void Clear ();
-
-private:
-  uint64_t m_rngRun;
-  std::vector<FlowData> m_flowData;
-  std::string m_fileName;
-  ScalarData m_allPacketsStats;
-  bool m_scalarFileWriteEnable;
-  bool m_vectorFileWriteEnable;
-  double m_histogramResolution;
-};
-
-} // namespace ns3
-
-#endif // STATS_DATA_H
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef STATS_DATA_H
+#define STATS_DATA_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <utility> // std::pair
+#include <unordered_map>
+#include <cstring>
+#include <chrono>
+
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/stats-hist.h"
+#include "ns3/stats-vector-file.h"
+#include "ns3/stats-header.h"
+#include "ns3/stats-overhead.h"
+#include "ns3/stats-profile.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+  
+
+/*******************************************************
+ * Summary & RunSummary
+ *******************************************************/
+struct Summary
+{
+	Summary ():
+		duration (0),
+		throughput (0),
+		txPackets (0),
+		rxPackets (0),
+		lostPackets (0),
+		lostRatio (0),
+		phyTxPkts (0),
+		usefullNetTraffic (0),
+		e2eDelayMin (0),
+		e2eDelayMax (0),
+		e2eDelayAverage (0),
+		e2eDelayMedianEstinate (0),
+		e2eDelayJitter (0),
+		e2eDelayP90 (0),
+		e2eDelayP95 (0),
+		e2eDelayP99 (0),
+		e2eDelayP999 (0)
+	{};
+	void IterativeAdd (const Summary &s, unsigned iteration);
+	/// Number of values in the summary (all members, in declaration order)
+	static const uint32_t N_VALUES = 17;
+	/**
+	 * \param index the value index (0 ... N_VALUES - 1)
+	 * \return the member name of the value, e.g. "throughput"
+	 */
+	static const char * GetValueName (uint32_t index);
+	/**
+	 * \param name the member name of the value
+	 * \return the value index, N_VALUES if there is no such value
+	 */
+	static uint32_t GetValueIndex (std::string name);
+	double GetValue (uint32_t index) const;
+
+	double duration;
+	double throughput;
+	double txPackets;
+	double rxPackets;
+	double lostPackets;
+	double lostRatio;
+  double phyTxPkts;
+  double usefullNetTraffic;
+	double e2eDelayMin;
+	double e2eDelayMax;
+	double e2eDelayAverage;
+	double e2eDelayMedianEstinate;
+	double e2eDelayJitter;
+	double e2eDelayP90;  // 90th percentile
+	double e2eDelayP95;  // 95th percentile
+	double e2eDelayP99;  // 99th percentile
+	double e2eDelayP999; // 99.9th percentile
+};
+
+// Cost of one simulation run, collected by StatsFlows
+struct RunPerformance
+{
+	RunPerformance () :
+		wallClockTime (0),
+		simulatedTime (0),
+		events (0),
+		statsCallbacks (0),
+		statsCallbackTime (0)
+	{};
+
+	double GetSimulatedOverWallClock () const { return wallClockTime > 0 ? simulatedTime / wallClockTime : 0.0; };
+	double GetEventsPerSecond () const { return wallClockTime > 0 ? events / wallClockTime : 0.0; };
+
+	double wallClockTime; // [s] from StatsFlows construction (or StartRun) to Finalize, i.e. Simulator::Run ()
+	double simulatedTime; // [s] simulation time at Finalize
+	uint64_t events; // simulator events executed in the same period
+	uint64_t statsCallbacks; // packet callbacks of StatsFlows and device Tx callbacks of StatsOverheadCollector
+	double statsCallbackTime; // [s] time spent in the StatsFlows packet callbacks (estimated from every 64th callback)
+};
+
+struct RunSummary
+{
+	RunSummary () :
+		numberOfFlows (0),
+		peakRss (0),
+		endRss (0)
+	{};
+
+	/**
+	 * \brief Write the run summary in host byte order (e.g. from a worker
+	 * process to the parent process, see StatsRunPool)
+	 * \param os the output stream
+	 */
+	void Serialize (std::ostream &os) const;
+	/**
+	 * \brief Restore the run summary written by Serialize ()
+	 * \param is the input stream
+	 * \return false if the stream ended before the whole summary was read
+	 */
+	bool Deserialize (std::istream &is);
+
+	unsigned int numberOfFlows;
+	uint64_t peakRss; // [B] peak resident memory of the run (StatsMemory), 0 if not measured
+	uint64_t endRss; // [B] resident memory after the run is destroyed, 0 if not measured
+	RunPerformance performance;
+	Summary aap; // All packets summary
+	Summary aaf; // All flows summary
+	StatsHist delayHist; // E2E delay histogram of all packets, can be merged across runs (StatsHist::Merge)
+};
+
+/*******************************************************
+ * PacketRecord
+ *******************************************************/
+// Fields of one sent or received test packet. StatsFlows decodes the StatsHeader
+// once per packet into this record and passes it to the all-packets and
+// the per-flow accumulators.
+struct PacketRecord
+{
+  int64_t txTimeStep;    // time stamp from the StatsHeader (time the packet was sent)
+  int64_t rxTimeStep;    // reception time (received packets only)
+  int64_t delayTimeStep; // rxTimeStep - txTimeStep (received packets only)
+  uint32_t seq;          // sequence number from the StatsHeader
+  uint32_t size;         // packet size [B]
+};
+
+/*******************************************************
+ * ScalarData
+ *******************************************************/
+struct ScalarData
+{
+  ScalarData (double histRes = 0.0001, uint8_t histLogLinear = 0, bool histSparse = false) 
+    : totalRxPackets (0),
+	    totalTxPackets (0),
+	    totalRxBytes (0),
+	    totalTxBytes (0),
+	    phyTxPkts (0),
+	    phyTxBytes (0),
+	    delayHist (histRes)  // 0.1 ms, default
+  {
+    delayHist.Clear ();
+    delayHist.SetLogLinear (histLogLinear);
+    delayHist.SetSparse (histSparse);
+  }
+
+  void Clear ()
+  {
+    totalRxPackets = 0;
+    totalTxPackets = 0;
+	  totalRxBytes = 0;
+	  totalTxBytes = 0;
+    phyTxPkts = 0;
+    phyTxBytes = 0;
+	  delayHist.Clear ();
+  }
+
+  void RecordSent (const PacketRecord &record);
+  void RecordReceived (const PacketRecord &record);
+
+  uint32_t totalRxPackets; // number of total application packets receiced
+  uint32_t totalTxPackets; // number of total application packets sent
+  uint64_t totalRxBytes;   // total received application bytes
+  uint64_t totalTxBytes;   // total transmitted application bytes
+  uint16_t packetSizeInBytes;
+  uint64_t phyTxPkts; // number of phy packets sent
+  uint64_t phyTxBytes; // phy bytes sent
+  Time firstPacketSent, lastPacketSent;
+  Time firstPacketReceived, lastPacketReceived;
+  Time firstDelay, lastDelay;
+  StatsHist delayHist;
+};
+
+/*******************************************************
+ * NetFlowKey
+ *******************************************************/
+// Packed form of the flow identification (source node, source app, sink address)
+// used as a hash key for fast flow lookup on every sent/received packet
+struct NetFlowKey
+{
+  NetFlowKey (uint32_t sonid, uint32_t soaid, uint64_t sinkKey)
+    : source (((uint64_t)sonid << 32) | soaid),
+      sink (sinkKey)
+  {};
+  NetFlowKey (uint32_t sonid, uint32_t soaid, const Address &siaddr)
+    : source (((uint64_t)sonid << 32) | soaid),
+      sink (StatsHeader::GetSinkKey (siaddr))
+  {};
+
+  bool operator== (const NetFlowKey &k) const
+  {
+    return source == k.source && sink == k.sink;
+  };
+
+  uint64_t source; // source node ID (high 32 bits) and source app ID (low 32 bits)
+  uint64_t sink; // sink IP address and port (StatsHeader::GetSinkKey)
+};
+
+struct NetFlowKeyHash
+{
+  std::size_t operator() (const NetFlowKey &k) const
+  {
+    // 64-bit mix (murmur3 finalizer) of both words
+    uint64_t h = k.source * 0x9e3779b97f4a7c15ULL ^ k.sink;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (std::size_t)h;
+  };
+};
+
+/*******************************************************
+ * NetFlowId
+ *******************************************************/
+// Identification of one flow, kept in every FlowData. The sink and source
+// addresses are stored packed into 64 bits (StatsHeader::GetSinkKey) and
+// resolved to Address only for the scalar file and logs.
+class NetFlowId
+{
+public:
+  NetFlowId (uint32_t sonid, uint32_t soaid, uint64_t siKey,
+             uint32_t sinid = 0, uint32_t siaid = 0, uint64_t soKey = 0, uint32_t i = 0)
+    : sinkKey (siKey),
+      sourceKey (soKey),
+      sourceNodeId (sonid),
+      sourceAppId (soaid),
+      sinkNodeId (sinid),
+      sinkAppId (siaid),
+      flowIndex (i)
+  {};
+  
+  std::string ToString () const;
+  std::string ToCsvString () const;
+  NetFlowKey GetKey () const { return NetFlowKey (sourceNodeId, sourceAppId, sinkKey); };
+  // Receiver IP address and port
+  Address GetSinkAddress () const { return StatsHeader::GetSinkAddress (sinkKey); };
+  // Sender IP address and port as seen by the receiver, Address () before the first received packet
+  Address GetSourceAddress () const { return sourceKey ? StatsHeader::GetSinkAddress (sourceKey) : Address (); };
+  /**
+   * \brief Set the sender address (from the first received packet)
+   * \param addr the sender address, not stored if it is not an IP socket address
+   */
+  void SetSourceAddress (const Address &addr);
+  
+  friend bool operator== (const NetFlowId &f1, const NetFlowId &f2);
+  uint64_t sinkKey; // sink IP address and port (StatsHeader::GetSinkKey)
+  uint64_t sourceKey; // source IP address and port packed the same way, 0 if not known
+  uint32_t sourceNodeId;
+  uint32_t sourceAppId;
+  uint32_t sinkNodeId;
+  uint32_t sinkAppId;
+  uint32_t flowIndex;
+};
+
+inline bool 
+operator== (const NetFlowId &f1, const NetFlowId &f2) 
+{
+  // the sink key is valid by construction (IPv4 or IPv6 address and port)
+  return f1.sourceNodeId == f2.sourceNodeId && f1.sourceAppId == f2.sourceAppId && f1.sinkKey == f2.sinkKey;
+}
+
+/*******************************************************
+ * FlowData
+ *******************************************************/
+// Per-flow record. It is kept as small as possible (no file names or file
+// writers per flow) because there can be hundreds of thousands of flows in one run.
+class FlowData
+{
+public:
+  FlowData (NetFlowId fid, bool scalarFileWriteEnable = false, bool vectorFileWriteEnable = false,
+            double histRes = 0.0001, uint8_t histLogLinear = 0, bool histSparse = false);
+
+  void PacketReceived (const PacketRecord &record) { m_scalarData.RecordReceived (record); };
+  void PacketSent (const PacketRecord &record) { m_scalarData.RecordSent (record); };
+  // Record of this flow accepted by the vector file (not discarded)
+  void VectorFileRecordWritten () { m_vectorFileRecords++; };
+  
+//  void SetScalarFileWriteEnable (bool b) { m_scalarFileWriteEnable = b; };
+  bool IsScalarFileWriteEnabled () { return m_scalarFileWriteEnable; } ;
+
+//  void SetVectorFileWriteEnable (bool b) { m_vectorFileWriteEnable = b; };
+  bool IsVectorFileWriteEnabled () { return m_vectorFileWriteEnable; } ;
+
+  Summary Finalize (std::ostream &out); // Final calculations and write to already opened scalar file (if enabled)
+  NetFlowId& GetFlowId () { return m_flowId; };
+  /**
+   * \return memory used by this flow record (object and histogram bins) [B]
+   */
+  uint32_t GetMemoryUsage () const { return sizeof (FlowData) - sizeof (StatsHist) + m_scalarData.delayHist.GetMemoryUsage (); };
+  const StatsHist & GetDelayHist () const { return m_scalarData.delayHist; };
+  bool IsFirstPacketReceived () { return m_scalarData.totalRxPackets == 0; };
+
+  void Clear () { m_scalarData.Clear (); m_vectorFileRecords = 0; };
+private:
+  NetFlowId m_flowId;
+  ScalarData m_scalarData;
+  bool m_scalarFileWriteEnable;
+  bool m_vectorFileWriteEnable;
+  uint32_t m_vectorFileRecords; // records written to the vector file
+};
+
+/*******************************************************
+ * StatsFlows
+ *******************************************************/
+class StatsFlows
+{
+public:
+  StatsFlows (uint64_t rngRun, std::string fn = "noname", bool scalarFileWriteEnable = false, bool vectorFileWriteEnable = false,
+              StatsVectorFile::Format vectorFileFormat = StatsVectorFile::CSV);
+  // Connected to the StatsPacketSink "RxRecord" and StatsPacketSource "TxRecord" trace sources
+  void RxRecord (const StatsPacketInfo &info, uint32_t sinkNodeId, uint32_t sinkAppId, const Address &sourceAddr);
+  void TxRecord (const StatsPacketInfo &info);
+  // Same as above for the packet based "Rx" and "Tx" trace sources (the header is decoded here),
+  // connected for applications without the record trace sources
+  void PacketReceived (Ptr<const Packet> packet, uint32_t sinkNodeId, uint32_t sinkAppId, Address sourceAddr);
+  void PacketSent (Ptr<const Packet> packet);
+  /**
+   * \brief Device transmissions used for the PHY over APP traffic ratio. "PhyTxBegin"
+   * of every device is attached by the constructor, other trace sources (Wi-Fi PHY)
+   * can be attached by the scenario before the simulation starts. When no device is
+   * attached the PHY values are reported as n/a.
+   */
+  StatsOverheadCollector & GetOverheadCollector () { return m_overhead; };
+
+  RunSummary Finalize ();
+
+  void SetFileName (std::string fileName) { m_fileName = fileName; };
+
+  void SetHistResolution (double res) { m_histogramResolution = res; m_allPacketsStats.delayHist.SetDefaultBinWidth (res); };
+  double GetHistResolution () { return m_histogramResolution; };
+  /**
+   * \brief Set the delay histogram layout (see StatsHist::SetLogLinear)
+   * \param subBucketBits 0 for fixed width bins (default), otherwise log-linear
+   * bins with relative precision 2^-subBucketBits (histogram resolution is the narrowest bin)
+   */
+  void SetHistLogLinear (uint8_t subBucketBits) { m_histogramLogLinear = subBucketBits; m_allPacketsStats.delayHist.SetLogLinear (subBucketBits); };
+  uint8_t GetHistLogLinear () { return m_histogramLogLinear; };
+  /**
+   * \brief Store only occupied histogram bins (see StatsHist::SetSparse) of the
+   * per-flow and of the all-packets histograms. By default the per-flow histograms
+   * are sparse (a dense per-flow histogram of 1 s delays at 0.1 ms bins takes 40 kB,
+   * for every flow) and the all-packets histogram is dense (one histogram, faster AddValue).
+   * Results are the same for both storages.
+   * \param sparse true for sparse, false for dense storage
+   */
+  void SetHistSparse (bool sparse) { m_histogramSparse = sparse; m_allPacketsStats.delayHist.SetSparse (sparse); };
+  bool IsHistSparse () { return m_histogramSparse; };
+  /**
+   * \return memory of the per-flow records of the current run (FlowData objects
+   * and histogram bins, without the flow index) [B]
+   */
+  uint64_t GetFlowMemoryUsage () const;
+
+  void SetScalarFileWriteEnable (bool b) { m_scalarFileWriteEnable = b; };
+  bool IsScalarFileWriteEnabled () { return m_scalarFileWriteEnable; } ;
+
+  void SetVectorFileWriteEnable (bool b) { m_vectorFileWriteEnable = b; };
+  bool IsVectorFileWriteEnabled () { return m_vectorFileWriteEnable; } ;
+  void SetVectorFileBufferSize (uint32_t bytes) { m_vectorFile.SetBufferSize (bytes); };
+  /**
+   * \brief Write the vector file from a separate writer thread (see StatsVectorFile::SetAsync)
+   * \param async true to enable the writer thread
+   * \param ringSize number of records queued between the simulator and the writer thread
+   * \param policy StatsVectorFile::BLOCK or StatsVectorFile::DROP when the queue is full
+   */
+  void SetVectorFileAsync (bool async, uint32_t ringSize = 1 << 16,
+                           StatsVectorFile::OverflowPolicy policy = StatsVectorFile::BLOCK)
+  {
+    m_vectorFile.SetAsync (async, ringSize, policy);
+  };
+
+  /**
+   * \brief Reuse this object for the next run: connect the trace sources of the
+   * current nodes (call after Finalize () and Simulator::Destroy () of the
+   * previous run, when the applications and devices of the new run are installed).
+   * Flow storage keeps its capacity, so runs of the same scenario do not reallocate it.
+   * \param rngRun the RNG run
+   * \param fn file name prefix (as in the constructor)
+   */
+  void StartRun (uint64_t rngRun, std::string fn);
+
+  void Clear ();
+
+private:
+  void ConnectTraces ();
+  // Record trace sources of the application, or its packet based "Tx" and "Rx" when it has no record traces
+  void ConnectApplication (Ptr<Application> app);
+  // Start of the performance measurement of the run
+  void StartPerformance ();
+  // Index of the packet's flow in m_flowData, m_flowData.size () if the flow is not known yet
+  uint32_t FindFlow (const StatsPacketInfo &info, const NetFlowKey &key);
+  void BindFlowSlot (uint32_t flowSlot, uint32_t i);
+
+  uint64_t m_rngRun;
+  std::vector<FlowData> m_flowData;
+  std::unordered_map<NetFlowKey, uint32_t, NetFlowKeyHash> m_flowIndex; // flow key -> index in m_flowData
+  std::vector<uint32_t> m_slotIndex; // flow slot (registered flow id) -> index in m_flowData
+  StatsOverheadCollector m_overhead; // per-device Tx counters
+  std::string m_fileName;
+  ScalarData m_allPacketsStats;
+  StatsVectorFile m_vectorFile; // buffered vector file writer shared by all flows, opened once per run
+  bool m_scalarFileWriteEnable;
+  bool m_vectorFileWriteEnable;
+  double m_histogramResolution;
+  uint8_t m_histogramLogLinear;
+  bool m_histogramSparse; // storage of the per-flow histograms
+  RunPerformance m_performance; // callback count and time of the current run
+  std::chrono::steady_clock::time_point m_wallClockStart;
+  uint64_t m_eventsStart; // Simulator::GetEventCount () at the start of the run
+#ifdef STATS_PROFILING
+  StatsProfile m_profile; // cost breakdown of the packet callbacks, written at Finalize
+#endif
+};
+
+} // namespace ns3
+
+#endif // STATS_DATA_H
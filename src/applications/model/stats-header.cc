@@ -18,7 +18,12 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <vector>
+#include <string>
+#include <unordered_map>
+
 #include "ns3/assert.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
 #include "ns3/simulator.h"
@@ -34,11 +39,116 @@ NS_LOG_COMPONENT_DEFINE ("StatsHeader");
 
 NS_OBJECT_ENSURE_REGISTERED (StatsHeader);
 
+const uint32_t StatsPacketInfo::NO_FLOW_SLOT;
+
+namespace {
+const uint8_t g_compactMarker = 0x80; // first byte of the compact format (full format starts with 4 or 6)
+
+// Flow registry for the compact format
+struct RegisteredFlow
+{
+  uint32_t nodeId;
+  uint32_t appId;
+  Address rxAddress;
+  uint64_t sinkKey;
+  int64_t baseTs;
+};
+
+std::vector<RegisteredFlow> &
+GetRegistry (void)
+{
+  static std::vector<RegisteredFlow> registry;
+  return registry;
+}
+
+bool g_registryClearScheduled = false; // ClearRegistry () is scheduled for Simulator::Destroy ()
+
+// IPv6 receiver addresses seen in this simulation, the index is a part of the sink key.
+// Not cleared between runs, sink keys of running applications stay valid.
+struct Ipv6SinkTable
+{
+  std::vector<Ipv6Address> addresses;
+  std::unordered_map<std::string, uint32_t> index; // 16 address bytes -> index
+};
+
+Ipv6SinkTable &
+GetIpv6SinkTable (void)
+{
+  static Ipv6SinkTable table;
+  return table;
+}
+
+const uint64_t g_sinkKeyIpv4 = (uint64_t)4 << 48;
+const uint64_t g_sinkKeyIpv6 = (uint64_t)6 << 48;
+
+uint64_t
+MakeIpv6SinkKey (const uint8_t buf[16], uint16_t port)
+{
+  Ipv6SinkTable &table = GetIpv6SinkTable ();
+  std::string bytes ((const char *)buf, 16);
+  std::unordered_map<std::string, uint32_t>::iterator it = table.index.find (bytes);
+  uint32_t i;
+  if (it == table.index.end ())
+    {
+      i = table.addresses.size ();
+      table.addresses.push_back (Ipv6Address::Deserialize (buf));
+      table.index.insert (std::make_pair (bytes, i));
+    }
+  else
+    {
+      i = it->second;
+    }
+  return g_sinkKeyIpv6 | ((uint64_t)i << 16) | port;
+}
+
+uint32_t
+GetVarintSize (uint64_t value)
+{
+  uint32_t size = 1;
+  while (value >= 0x80)
+    {
+      value >>= 7;
+      size++;
+    }
+  return size;
+}
+
+void
+WriteVarint (Buffer::Iterator &i, uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      i.WriteU8 ((uint8_t)(value | 0x80));
+      value >>= 7;
+    }
+  i.WriteU8 ((uint8_t)value);
+}
+
+uint64_t
+ReadVarint (Buffer::Iterator &i)
+{
+  uint64_t value = 0;
+  uint8_t byte;
+  uint32_t shift = 0;
+  do
+    {
+      byte = i.ReadU8 ();
+      value |= (uint64_t)(byte & 0x7f) << shift;
+      shift += 7;
+    }
+  while ((byte & 0x80) && shift < 64);
+  return value;
+}
+} // anonymous namespace
+
 StatsHeader::StatsHeader ()
   : m_seq (0),
     m_ts (Simulator::Now ().GetTimeStep ()),
     m_nodeId (0),
-    m_appId (0)
+    m_appId (0),
+    m_sinkKey (0),
+    m_compact (false),
+    m_flowId (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -91,6 +201,93 @@ StatsHeader::GetApplicationId (void) const
   return m_appId;
 }
 
+void
+StatsHeader::SetCompact (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+  NS_ABORT_MSG_IF (flowId >= GetRegistry ().size (), "SetCompact: flow " << flowId << " is not registered");
+  NS_ASSERT_MSG ((int64_t)m_ts >= GetRegistry ()[flowId].baseTs, "SetCompact: time stamp is before the flow's base time");
+  m_compact = true;
+  m_flowId = flowId;
+}
+
+uint32_t
+StatsHeader::RegisterFlow (uint32_t nodeId, uint32_t appId, const Address &rxAddress, Time baseTime)
+{
+  NS_LOG_FUNCTION (nodeId << appId << baseTime);
+  NS_ASSERT_MSG (InetSocketAddress::IsMatchingType (rxAddress) || Inet6SocketAddress::IsMatchingType (rxAddress),
+                 "RegisterFlow: Address is not correct! Type must be InetSocketAddress or Inet6SocketAddress");
+  RegisteredFlow flow;
+  flow.nodeId = nodeId;
+  flow.appId = appId;
+  flow.rxAddress = rxAddress;
+  flow.sinkKey = GetSinkKey (rxAddress);
+  flow.baseTs = baseTime.GetTimeStep ();
+  if (!g_registryClearScheduled)
+    {
+      // flow ids are used by the applications until the end of the simulation
+      Simulator::ScheduleDestroy (&StatsHeader::ClearRegistry);
+      g_registryClearScheduled = true;
+    }
+  GetRegistry ().push_back (flow);
+  return GetRegistry ().size () - 1;
+}
+
+void
+StatsHeader::ClearRegistry (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::vector<RegisteredFlow> ().swap (GetRegistry ());
+  g_registryClearScheduled = false;
+}
+
+uint32_t
+StatsHeader::GetNRegisteredFlows (void)
+{
+  return GetRegistry ().size ();
+}
+
+void
+StatsHeader::GetPacketInfo (StatsPacketInfo &info) const
+{
+  info.seq = m_seq;
+  info.txTimeStep = m_ts;
+  info.sourceNodeId = m_nodeId;
+  info.sourceAppId = m_appId;
+  info.sinkKey = m_sinkKey;
+  info.flowSlot = m_compact ? m_flowId : StatsPacketInfo::NO_FLOW_SLOT;
+}
+
+uint64_t
+StatsHeader::GetSinkKey (const Address &addr)
+{
+  if (InetSocketAddress::IsMatchingType (addr))
+    {
+      InetSocketAddress inetAddr = InetSocketAddress::ConvertFrom (addr);
+      return g_sinkKeyIpv4 | ((uint64_t)inetAddr.GetIpv4 ().Get () << 16) | inetAddr.GetPort ();
+    }
+  NS_ASSERT_MSG (Inet6SocketAddress::IsMatchingType (addr),
+                 "GetSinkKey: Address is not correct! Type must be InetSocketAddress or Inet6SocketAddress");
+  Inet6SocketAddress inetAddr = Inet6SocketAddress::ConvertFrom (addr);
+  uint8_t buf[16];
+  inetAddr.GetIpv6 ().Serialize (buf);
+  return MakeIpv6SinkKey (buf, inetAddr.GetPort ());
+}
+
+Address
+StatsHeader::GetSinkAddress (uint64_t sinkKey)
+{
+  uint16_t port = sinkKey & 0xffff;
+  uint32_t address = (sinkKey >> 16) & 0xffffffff;
+  if ((sinkKey & ~(uint64_t)0xffffffffffffULL) == g_sinkKeyIpv4)
+    {
+      return InetSocketAddress (Ipv4Address (address), port);
+    }
+  NS_ASSERT_MSG ((sinkKey & ~(uint64_t)0xffffffffffffULL) == g_sinkKeyIpv6
+                 && address < GetIpv6SinkTable ().addresses.size (), "GetSinkAddress: not a valid sink key");
+  return Inet6SocketAddress (GetIpv6SinkTable ().addresses[address], port);
+}
+
 TypeId
 StatsHeader::GetTypeId (void)
 {
@@ -114,6 +311,7 @@ StatsHeader::SetRxAddress (const Address &addr)
   if (InetSocketAddress::IsMatchingType (addr) || Inet6SocketAddress::IsMatchingType (addr)) 
     {
       m_rxAddress = addr;
+      m_sinkKey = GetSinkKey (addr);
     }
   else
     {
@@ -133,7 +331,7 @@ StatsHeader::ToString () const
 {
   NS_LOG_FUNCTION (this);
   std::ostringstream os;
-  os << "(seq=" << m_seq << " time=" << TimeStep (m_ts).GetSeconds () << " nodeId=" << m_nodeId << " appId=" << m_appId << " Ip=";
+  os << "(" << (m_compact ? "flowId=" + std::to_string (m_flowId) + " " : "") << "seq=" << m_seq << " time=" << TimeStep (m_ts).GetSeconds () << " nodeId=" << m_nodeId << " appId=" << m_appId << " Ip=";
   if (InetSocketAddress::IsMatchingType (m_rxAddress))
     {
       os << InetSocketAddress::ConvertFrom (m_rxAddress).GetIpv4 ()
@@ -158,15 +356,21 @@ StatsHeader::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t size = 0;
-  if (InetSocketAddress::IsMatchingType (m_rxAddress)) 
+  if (m_compact)
+    {
+      NS_ABORT_MSG_IF (m_flowId >= GetRegistry ().size (), "GetSerializedSize: flow " << m_flowId << " is not registered");
+      size = sizeof(uint8_t) + GetVarintSize (m_flowId) + GetVarintSize (m_seq)
+        + GetVarintSize (m_ts - GetRegistry ()[m_flowId].baseTs);
+    }
+  else if (InetSocketAddress::IsMatchingType (m_rxAddress)) 
     {
       size = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(Ipv4Address) + sizeof(uint16_t);
-      //size = 4+8+4+4+1+4+2; // seq+ts+nodeId+appId+addrType+ipv4+port
+      //size = 1+4+8+4+4+4+2; // addrType+seq+ts+nodeId+appId+ipv4+port
     }
   else if (Inet6SocketAddress::IsMatchingType (m_rxAddress))
     {
       size = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(Ipv6Address) + sizeof(uint16_t);
-      //size = 4+8+4+4+1+16+2; // seq+ts+nodeId+appId+addrType+ipv6+port
+      //size = 1+4+8+4+4+16+2; // addrType+seq+ts+nodeId+appId+ipv6+port
     }
   else
     {
@@ -181,35 +385,38 @@ StatsHeader::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  if (m_compact)
+    {
+      NS_ABORT_MSG_IF (m_flowId >= GetRegistry ().size (), "Serialize: flow " << m_flowId << " is not registered");
+      i.WriteU8 (g_compactMarker);
+      WriteVarint (i, m_flowId);
+      WriteVarint (i, m_seq);
+      WriteVarint (i, m_ts - GetRegistry ()[m_flowId].baseTs);
+      return;
+    }
+  // address type first, it also tells the full format from the compact one
+  i.WriteU8 (InetSocketAddress::IsMatchingType (m_rxAddress) ? 4 : 6);
   i.WriteHtonU32 (m_seq);
   i.WriteHtonU64 (m_ts);
   i.WriteHtonU32 (m_nodeId);
   i.WriteHtonU32 (m_appId);
   if (InetSocketAddress::IsMatchingType (m_rxAddress)) 
     {
-      i.WriteU8 (4);
       InetSocketAddress inetAddr = InetSocketAddress::ConvertFrom (m_rxAddress);
       Ipv4Address ipAddr = inetAddr.GetIpv4 ();
       uint8_t buf[4];
       ipAddr.Serialize (buf);
-      for (int k=0; k<4; k++)
-        {
-          i.WriteU8 (buf[k]); // network order
-        }
+      i.Write (buf, 4); // network order
       uint16_t port = inetAddr.GetPort ();
       i.WriteHtonU16 (port);
     }
   else if (Inet6SocketAddress::IsMatchingType (m_rxAddress))
     {
-      i.WriteU8 (6);
       Inet6SocketAddress inetAddr = Inet6SocketAddress::ConvertFrom (m_rxAddress);
       Ipv6Address ipAddr = inetAddr.GetIpv6 ();
       uint8_t buf[16];
       ipAddr.Serialize (buf);
-      for (int k=0; k<16; k++)
-        {
-          i.WriteU8 (buf[k]); 
-        }
+      i.Write (buf, 16);
       uint16_t port = inetAddr.GetPort ();
       i.WriteHtonU16 (port);
     }
@@ -224,38 +431,49 @@ StatsHeader::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  uint8_t addrType = i.ReadU8 ();
+  if (addrType == g_compactMarker)
+    {
+      m_compact = true;
+      m_flowId = ReadVarint (i);
+      NS_ABORT_MSG_IF (m_flowId >= GetRegistry ().size (), "Deserialize: flow " << m_flowId << " is not registered");
+      const RegisteredFlow &flow = GetRegistry ()[m_flowId];
+      m_seq = ReadVarint (i);
+      m_ts = flow.baseTs + ReadVarint (i);
+      m_nodeId = flow.nodeId;
+      m_appId = flow.appId;
+      m_rxAddress = flow.rxAddress;
+      m_sinkKey = flow.sinkKey;
+      return i.GetDistanceFrom (start);
+    }
+  m_compact = false;
   m_seq = i.ReadNtohU32 ();
   m_ts = i.ReadNtohU64 ();
   m_nodeId = i.ReadNtohU32 ();
   m_appId = i.ReadNtohU32 ();
-  uint8_t addrType = i.ReadU8 ();
   if (addrType == 4) 
     {
       uint8_t buf[4];
-      for (int k=0; k<4; k++)
-        {
-          buf[k] = i.ReadU8 (); // network order
-        }
+      i.Read (buf, 4); // network order
       Ipv4Address ipAddr = Ipv4Address::Deserialize (buf);
       uint16_t port = i.ReadNtohU16 ();
       m_rxAddress = InetSocketAddress (ipAddr, port);
+      m_sinkKey = g_sinkKeyIpv4 | ((uint64_t)ipAddr.Get () << 16) | port;
     }
   else if (addrType == 6)
     {
       uint8_t buf[16];
-      for (int k=0; k<16; k++)
-        {
-          buf[k] = i.ReadU8 (); 
-        }
+      i.Read (buf, 16);
       Ipv6Address ipAddr = Ipv6Address::Deserialize (buf);
       uint16_t port = i.ReadNtohU16 ();
       m_rxAddress = Inet6SocketAddress (ipAddr, port);
+      m_sinkKey = MakeIpv6SinkKey (buf, port);
     }
   else
     {
       NS_ASSERT_MSG (0, "Deserialize: Address is not correct! Type must be InetSocketAddress or Inet6SocketAddress");
     }  
-  return GetSerializedSize ();
+  return i.GetDistanceFrom (start);
 }
 
 } // namespace ns3
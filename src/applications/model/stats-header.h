@@ -26,13 +26,44 @@
 #include "ns3/address.h"
 
 namespace ns3 {
+
+/**
+ * \brief StatsHeader fields of one test packet, already decoded.
+ *
+ * Passed by the StatsPacketSource "TxRecord" and StatsPacketSink "RxRecord"
+ * trace sources, so listeners do not have to peek the header again.
+ */
+struct StatsPacketInfo
+{
+  static const uint32_t NO_FLOW_SLOT = 0xffffffff; //!< flowSlot of packets without a registered flow
+
+  uint32_t seq;          //!< Sequence number
+  int64_t txTimeStep;    //!< Time stamp (time the packet was sent)
+  uint32_t sourceNodeId; //!< Sender Node Id
+  uint32_t sourceAppId;  //!< Sender Application Id
+  uint64_t sinkKey;      //!< Receiver address and port (StatsHeader::GetSinkKey)
+  uint32_t size;         //!< Packet size [B]
+  uint32_t flowSlot;     //!< Registered flow id (compact header flows), or NO_FLOW_SLOT
+};
+
 /**
  * \ingroup udpclientserver
  *
  * \brief Packet header for UDP client/server application.
  *
- * The header is made of a 32bits sequence number followed by
- * a 64bits time stamp, followed by 32 bit NodeId.
+ * Full format (27 bytes for IPv4, 39 bytes for IPv6 receiver): 8 bit
+ * receiver address type (4 or 6), 32 bit sequence number, 64 bit time stamp,
+ * 32 bit sender NodeId, 32 bit sender application Id, receiver IP address
+ * and 16 bit port.
+ *
+ * Compact format (SetCompact (), typically 8-12 bytes): 8 bit marker 0x80,
+ * varint flow id, varint sequence number, varint time stamp offset from the
+ * flow's base time. Sender ids, receiver address and base time are kept in a
+ * registry (RegisterFlow ()) shared by all nodes of the simulation, so after
+ * Deserialize () all getters return the same values as for the full format.
+ * The registry lives as long as the simulation: it is cleared by
+ * Simulator::Destroy (), not by StatsFlows, so flow ids of running sources
+ * stay valid whatever StatsFlows objects are finalized or cleared.
  */
 class StatsHeader : public Header
 {
@@ -84,6 +115,66 @@ public:
       return m_rxAddress;
     };
 
+  /**
+   * \return the receiver's IP address and port packed into 64 bits (see GetSinkKey (const Address &))
+   */
+  uint64_t GetSinkKey (void) const
+    {
+      return m_sinkKey;
+    };
+  /**
+   * \brief Fill all header fields of the packet info (packet size is left unchanged).
+   * The flow slot is the registered flow id for the compact format.
+   * \param info the packet info
+   */
+  void GetPacketInfo (StatsPacketInfo &info) const;
+
+  /**
+   * \brief Pack the receiver address into 64 bits: address type (4 or 6) in the
+   * high 16 bits, IPv4 address (or index of the IPv6 address in a table kept
+   * for the whole simulation) in the next 32 bits and port in the low 16 bits.
+   * \param addr InetSocketAddress or Inet6SocketAddress
+   * \return the sink key
+   */
+  static uint64_t GetSinkKey (const Address &addr);
+  /**
+   * \param sinkKey the sink key returned by GetSinkKey ()
+   * \return the receiver's IP address and port (InetSocketAddress or Inet6SocketAddress)
+   */
+  static Address GetSinkAddress (uint64_t sinkKey);
+
+  /**
+   * \brief Use the compact format for this header.
+   * Sender ids and receiver address must be the ones registered for the flow.
+   * \param flowId the flow id returned by RegisterFlow ()
+   */
+  void SetCompact (uint32_t flowId);
+  bool IsCompact (void) const
+    {
+      return m_compact;
+    };
+  uint32_t GetFlowId (void) const
+    {
+      return m_flowId;
+    };
+
+  /**
+   * \brief Register a flow for the compact header format
+   * \param nodeId the sender's node ID
+   * \param appId the sender's application ID
+   * \param rxAddress the receiver's IP address and port
+   * \param baseTime time stamps of the flow are sent as offsets from this time
+   * \return the flow id
+   */
+  static uint32_t RegisterFlow (uint32_t nodeId, uint32_t appId, const Address &rxAddress, Time baseTime);
+  /**
+   * \brief Remove all registered flows. Called by Simulator::Destroy () (scheduled
+   * with the first registered flow); call it directly only when no packet with a
+   * compact header of the registered flows is sent or received any more.
+   */
+  static void ClearRegistry (void);
+  static uint32_t GetNRegisteredFlows (void);
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -104,6 +195,9 @@ private:
   uint32_t m_nodeId; //!< Sender Node Id
   uint32_t m_appId; //!< Sender Application Id
   Address m_rxAddress; //!< Receiver IP address (IPv4 or IPv6) and port (InetSocketAddress or Inet6SocketAddress)
+  uint64_t m_sinkKey; //!< m_rxAddress packed into 64 bits
+  bool m_compact; //!< Compact format
+  uint32_t m_flowId; //!< Registered flow id (compact format)
 };
 
 } // namespace ns3
@@ -33,6 +33,8 @@ NS_LOG_COMPONENT_DEFINE ("StatsHist");
 
 StatsHist::StatsHist (double binWidth, std::string unit) 
   : m_binWidth (binWidth),
+    m_subBucketBits (0),
+    m_sparseStorage (false),
     m_unit (unit),
     m_count (0),
     m_total (0.0),
@@ -54,7 +56,10 @@ StatsHist::StatsHist (double binWidth, std::string unit)
 void
 StatsHist::Clear ()
 {
-  m_histogram.clear();
+  // release the bins, one run with outliers must not keep its memory for the following runs
+  std::vector<uint32_t> ().swap (m_histogram);
+  std::vector<std::pair<uint32_t, uint32_t> > ().swap (m_sparse);
+  std::vector<uint64_t> ().swap (m_cumulative);
   m_count = 0;
   m_total = 0;
   m_squareTotal = 0;
@@ -70,25 +75,67 @@ StatsHist::Clear ()
 uint32_t 
 StatsHist::GetNBins () const
 {
+  if (m_sparseStorage)
+    {
+      return m_sparse.empty () ? 0 : m_sparse.back ().first + 1;
+    }
   return m_histogram.size ();
 }
 
 double 
 StatsHist::GetBinStart (uint32_t index) const
 {
-  return index*m_binWidth;
+  uint32_t subBuckets = 1 << m_subBucketBits;
+  if (m_subBucketBits == 0 || index < 2 * subBuckets)
+    {
+      return index*m_binWidth;
+    }
+  // index = shift*subBuckets + (units >> shift)
+  uint32_t shift = index / subBuckets - 1;
+  return std::ldexp ((double)(index - shift * subBuckets), shift) * m_binWidth;
 }
 
 double 
 StatsHist::GetBinEnd (uint32_t index) const
 {
-  return (index + 1) * m_binWidth;
+  return GetBinStart (index + 1);
 }
 
 double 
 StatsHist::GetBinMiddle (uint32_t index) const
 {
-  return (index+0.5)*m_binWidth;
+  if (m_subBucketBits == 0)
+    {
+      return (index+0.5)*m_binWidth;
+    }
+  return 0.5 * (GetBinStart (index) + GetBinEnd (index));
+}
+
+uint32_t
+StatsHist::GetIndex (double value) const
+{
+  double units = std::floor (value/m_binWidth);
+  if (m_subBucketBits == 0)
+    {
+      return (uint32_t)units;
+    }
+  uint32_t subBuckets = 1 << m_subBucketBits;
+  if (units < 2 * subBuckets)
+    {
+      return (uint32_t)units;
+    }
+  units = std::min (units, std::ldexp (1.0, 62));
+  int exponent;
+  std::frexp (units, &exponent); // units = m * 2^exponent, 0.5 <= m < 1
+  uint32_t shift = exponent - 1 - m_subBucketBits;
+  return shift * subBuckets + (uint32_t)((uint64_t)units >> shift);
+}
+
+double
+StatsHist::GetResolution (double value) const
+{
+  uint32_t index = GetIndex (value);
+  return GetBinEnd (index) - GetBinStart (index);
 }
 
 
@@ -101,31 +148,80 @@ StatsHist::GetBinWidth () const
 void 
 StatsHist::SetDefaultBinWidth (double binWidth)
 {
-  NS_ASSERT (m_histogram.size () == 0); //we can only change the bin width if no values were added
+  NS_ASSERT (m_count == 0); //we can only change the bin width if no values were added
   m_binWidth = binWidth;
 }
 
+void
+StatsHist::SetLogLinear (uint8_t subBucketBits)
+{
+  NS_ASSERT (m_count == 0); //we can only change the layout if no values were added
+  NS_ASSERT_MSG (subBucketBits <= 16, "Log-linear histogram supports up to 16 sub-bucket bits.");
+  m_subBucketBits = subBucketBits;
+}
+
+void
+StatsHist::SetSparse (bool sparse)
+{
+  NS_ASSERT (m_count == 0); //we can only change the storage if no values were added
+  m_sparseStorage = sparse;
+  m_histogram.clear ();
+  m_sparse.clear ();
+}
+
 uint32_t 
 StatsHist::GetBinCount (uint32_t index) const
 {
-  NS_ASSERT (index < m_histogram.size ());
+  NS_ASSERT (index < GetNBins ());
+  if (m_sparseStorage)
+    {
+      std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it =
+        std::lower_bound (m_sparse.begin (), m_sparse.end (), std::make_pair (index, (uint32_t)0));
+      return (it != m_sparse.end () && it->first == index) ? it->second : 0;
+    }
   return m_histogram[index];
 }
 
+void
+StatsHist::AddToBin (uint32_t index, uint32_t count)
+{
+  if (!m_sparseStorage)
+    {
+      if (index >= m_histogram.size ())
+        {
+          m_histogram.resize (index + 1, 0);
+        }
+      m_histogram[index] += count;
+      return;
+    }
+  // most values fall into the last (highest) occupied bin or above it
+  if (m_sparse.empty () || m_sparse.back ().first < index)
+    {
+      m_sparse.push_back (std::make_pair (index, count));
+      return;
+    }
+  std::vector<std::pair<uint32_t, uint32_t> >::iterator it =
+    std::lower_bound (m_sparse.begin (), m_sparse.end (), std::make_pair (index, (uint32_t)0));
+  if (it->first == index)
+    {
+      it->second += count;
+    }
+  else
+    {
+      m_sparse.insert (it, std::make_pair (index, count));
+    }
+}
+
 void 
 StatsHist::AddValue (double value)
 {
 
-  uint32_t index = (uint32_t)std::floor (value/m_binWidth);
+  uint32_t index = GetIndex (value);
 
   //check if we need to resize the vector
   NS_LOG_DEBUG ("AddValue: index=" << index << ", m_histogram.size()=" << m_histogram.size ());
 
-  if (index >= m_histogram.size ())
-    {
-      m_histogram.resize (index + 1, 0);
-    }
-  m_histogram[index]++;
+  AddToBin (index, 1);
 
   // borrowed from Joe Kopena
   m_count++;
@@ -180,39 +276,138 @@ StatsHist::AddValue (double value)
     }
 }
 
+void
+StatsHist::Rebin (double binWidth)
+{
+  NS_ASSERT (m_subBucketBits == 0);
+  std::vector<uint32_t> oldDense;
+  std::vector<std::pair<uint32_t, uint32_t> > oldSparse;
+  oldDense.swap (m_histogram);
+  oldSparse.swap (m_sparse);
+  double oldBinWidth = m_binWidth;
+  m_binWidth = binWidth;
+  uint32_t n = m_sparseStorage ? oldSparse.size () : oldDense.size ();
+  for (uint32_t pos = 0; pos < n; ++pos)
+    {
+      uint32_t i = m_sparseStorage ? oldSparse[pos].first : pos;
+      uint32_t count = m_sparseStorage ? oldSparse[pos].second : oldDense[pos];
+      if (count > 0)
+        {
+          AddToBin (GetIndex ((i + 0.5) * oldBinWidth), count);
+        }
+    }
+}
+
+void
+StatsHist::Merge (const StatsHist &other)
+{
+  NS_LOG_FUNCTION (this << other.m_count);
+  if (other.m_count == 0)
+    {
+      return;
+    }
+
+  // Bins (empty histogram takes the layout of the other one)
+  if (m_count == 0)
+    {
+      m_histogram.clear ();
+      m_sparse.clear ();
+      m_binWidth = other.m_binWidth;
+      m_subBucketBits = other.m_subBucketBits;
+    }
+  if (m_subBucketBits == 0 && other.m_subBucketBits == 0 && other.m_binWidth > m_binWidth)
+    {
+      Rebin (other.m_binWidth);
+    }
+  bool sameLayout = (m_subBucketBits == other.m_subBucketBits && m_binWidth == other.m_binWidth);
+  if (sameLayout && !m_sparseStorage && !other.m_sparseStorage)
+    {
+      if (other.m_histogram.size () > m_histogram.size ())
+        {
+          m_histogram.resize (other.m_histogram.size (), 0);
+        }
+      for (uint32_t i = 0; i < other.m_histogram.size (); ++i)
+        {
+          m_histogram[i] += other.m_histogram[i];
+        }
+    }
+  else
+    {
+      for (uint32_t pos = 0; pos < other.GetNStored (); ++pos)
+        {
+          uint32_t count = other.GetStoredCount (pos);
+          if (count == 0)
+            {
+              continue;
+            }
+          uint32_t i = other.GetStoredIndex (pos);
+          AddToBin (sameLayout ? i : GetIndex (other.GetBinMiddle (i)), count);
+        }
+    }
+
+  // Count, sum, min, max
+  if (m_count == 0)
+    {
+      m_min = other.m_min;
+      m_max = other.m_max;
+    }
+  else
+    {
+      m_min = std::min (m_min, other.m_min);
+      m_max = std::max (m_max, other.m_max);
+    }
+  long count = m_count + other.m_count;
+  m_total += other.m_total;
+  m_squareTotal += other.m_squareTotal;
+
+  // Mean and variance: Chan, Golub, LeVeque, "Updating Formulae and a Pairwise
+  // Algorithm for Computing Sample Variances", 1979
+  double delta = other.m_meanCurr - m_meanCurr;
+  m_meanCurr = m_meanCurr + delta * other.m_count / count;
+  m_sCurr = m_sCurr + other.m_sCurr + delta * delta * ((double)m_count * other.m_count / count);
+  m_varianceCurr = (count > 1) ? m_sCurr / (count - 1) : 0;
+  m_meanPrev = m_meanCurr;
+  m_sPrev = m_sCurr;
+  m_count = count;
+}
+
 double 
 StatsHist::GetMedianEstimation () const
 {
-  int64_t leftIndex=0, rightIndex=m_histogram.size ()-1;
+  if (m_sparseStorage)
+    {
+      return GetSparseMedianEstimation ();
+    }
+  int64_t leftIndex=0, rightIndex=(int64_t)GetNBins ()-1;
   if (rightIndex==-1) return 0;
-  if (rightIndex==0) return 0.5*m_binWidth;
-  uint32_t leftCount=m_histogram[leftIndex], rightCount=m_histogram[rightIndex];
+  if (rightIndex==0) return GetBinMiddle (0);
+  uint32_t leftCount=GetBinCount (leftIndex), rightCount=GetBinCount (rightIndex);
 
   while (rightIndex-leftIndex>1) //there are at least 1 bin between left and right index
   {
     if (leftCount<rightCount) // number of values in right bins is higher
       {
         leftIndex++; // reduce hist from the left
-        leftCount+=m_histogram[leftIndex];
+        leftCount+=GetBinCount (leftIndex);
       }
     else if (leftCount>rightCount) // number of values in left bins is higher
       {
         rightIndex--; // reduce hist from the right
-        rightCount+=m_histogram[rightIndex];
+        rightCount+=GetBinCount (rightIndex);
       }
     else // number of values in rigth and left bins is the same so far
       {
         if (rightIndex-leftIndex>2) // reduce hist from left and right if possibile 
           {
             leftIndex++;
-            leftCount+=m_histogram[leftIndex];            
+            leftCount+=GetBinCount (leftIndex);            
             rightIndex--;
-            rightCount+=m_histogram[rightIndex];
+            rightCount+=GetBinCount (rightIndex);
           }
         else // there is only 1 been between left and right so this bin is solution
           {
             leftIndex++;
-            return (leftIndex+0.5)*m_binWidth;
+            return GetBinMiddle (leftIndex);
           }
       }
   }
@@ -220,18 +415,138 @@ StatsHist::GetMedianEstimation () const
   // At this point there is no more bins between lef and right side of reduced hist
   if (leftCount>rightCount) // left side has more values
     {
-      return (leftIndex+0.5)*m_binWidth;
+      return GetBinMiddle (leftIndex);
     }
   else if (leftCount<rightCount) // right side has more values
     {
-      return (rightIndex+0.5)*m_binWidth;
+      return GetBinMiddle (rightIndex);
     }
   else // number of values is the same in left and righ side of reduced hist
     {
-      return rightIndex*m_binWidth;
+      return GetBinStart (rightIndex);
     }
 }
 
+double
+StatsHist::GetSparseMedianEstimation () const
+{
+  // The same walk as in GetMedianEstimation, but a run of empty bins is
+  // passed in one step (counts do not change inside it)
+  int64_t nOccupied = m_sparse.size ();
+  int64_t leftIndex=0, rightIndex=(int64_t)GetNBins ()-1;
+  if (rightIndex==-1) return 0;
+  if (rightIndex==0) return GetBinMiddle (0);
+  // lp: first occupied bin right of leftIndex, rp: last occupied bin left of rightIndex
+  int64_t lp = 0, rp = nOccupied - 2;
+  uint64_t leftCount = 0, rightCount = m_sparse[nOccupied - 1].second;
+  if (m_sparse[0].first == 0)
+    {
+      leftCount = m_sparse[0].second;
+      lp = 1;
+    }
+
+  while (rightIndex-leftIndex>1)
+  {
+    int64_t nextLeft = (lp < nOccupied && m_sparse[lp].first < rightIndex) ? m_sparse[lp].first : rightIndex;
+    int64_t prevRight = (rp >= 0 && m_sparse[rp].first > leftIndex) ? m_sparse[rp].first : leftIndex;
+    if (leftCount<rightCount)
+      {
+        leftIndex = std::min (nextLeft, rightIndex-1);
+        if (leftIndex == nextLeft)
+          {
+            leftCount += m_sparse[lp++].second;
+          }
+      }
+    else if (leftCount>rightCount)
+      {
+        rightIndex = std::max (prevRight, leftIndex+1);
+        if (rightIndex == prevRight)
+          {
+            rightCount += m_sparse[rp--].second;
+          }
+      }
+    else
+      {
+        if (rightIndex-leftIndex>2)
+          {
+            int64_t step = std::min (std::min (nextLeft-leftIndex, rightIndex-prevRight), (rightIndex-leftIndex-3)/2+1);
+            leftIndex += step;
+            rightIndex -= step;
+            if (leftIndex == nextLeft)
+              {
+                leftCount += m_sparse[lp++].second;
+              }
+            if (rightIndex == prevRight)
+              {
+                rightCount += m_sparse[rp--].second;
+              }
+          }
+        else
+          {
+            leftIndex++;
+            return GetBinMiddle (leftIndex);
+          }
+      }
+  }
+
+  if (leftCount>rightCount)
+    {
+      return GetBinMiddle (leftIndex);
+    }
+  else if (leftCount<rightCount)
+    {
+      return GetBinMiddle (rightIndex);
+    }
+  else
+    {
+      return GetBinStart (rightIndex);
+    }
+}
+
+double
+StatsHist::GetQuantile (double q) const
+{
+  NS_ASSERT_MSG (q >= 0.0 && q <= 1.0, "Quantile must be in [0, 1].");
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  uint32_t n = GetNStored ();
+  if (m_cumulative.size () != n || m_cumulative.back () != (uint64_t)m_count)
+    {
+      // (re)build the cumulative index once after values were added
+      m_cumulative.resize (n);
+      uint64_t cumulative = 0;
+      for (uint32_t pos = 0; pos < n; ++pos)
+        {
+          cumulative += GetStoredCount (pos);
+          m_cumulative[pos] = cumulative;
+        }
+    }
+
+  // nearest rank of the quantile (1 ... m_count)
+  double rank = std::max (1.0, std::ceil (q * m_count));
+  uint32_t pos = std::lower_bound (m_cumulative.begin (), m_cumulative.end (), (uint64_t)rank) - m_cumulative.begin ();
+  if (pos >= n)
+    {
+      return m_max;
+    }
+  uint64_t before = (pos == 0) ? 0 : m_cumulative[pos - 1];
+  uint32_t i = GetStoredIndex (pos);
+  // values are assumed evenly spread inside the bin
+  double fraction = (rank - before - 0.5) / GetStoredCount (pos);
+  double value = GetBinStart (i) + fraction * (GetBinEnd (i) - GetBinStart (i));
+  return std::min (m_max, std::max (m_min, value));
+}
+
+uint32_t
+StatsHist::GetMemoryUsage () const
+{
+  return sizeof (StatsHist) + m_histogram.capacity () * sizeof (uint32_t)
+         + m_sparse.capacity () * sizeof (std::pair<uint32_t, uint32_t>)
+         + m_cumulative.capacity () * sizeof (uint64_t);
+}
+
 void
 StatsHist::WriteToCsvFile (std::string fileName, double writeBinWidth, std::string description) const
 {
@@ -245,10 +560,60 @@ StatsHist::WriteToCsvFile (std::string fileName, double writeBinWidth, std::stri
     {
       writeBinWidth = m_binWidth;
     }
+
+  uint32_t n = GetNBins ();
+  if (m_subBucketBits > 0)
+    {
+      // Log-linear bins are merged while they fall into the same writeBinWidth
+      // interval; bins wider than writeBinWidth are written as they are
+      uint32_t pos = 0;
+      while (pos < GetNStored ())
+        {
+          if (GetStoredCount (pos) == 0)
+            {
+              pos++;
+              continue;
+            }
+          uint32_t first = GetStoredIndex (pos), last = first;
+          double interval = std::floor (GetBinStart (first) / writeBinWidth);
+          uint32_t mergeSum = 0;
+          while (pos < GetNStored () && std::floor (GetBinStart (GetStoredIndex (pos)) / writeBinWidth) == interval)
+            {
+              if (GetStoredCount (pos) > 0)
+                {
+                  mergeSum += GetStoredCount (pos);
+                  last = GetStoredIndex (pos);
+                }
+              pos++;
+            }
+          out << 0.5 * (GetBinStart (first) + GetBinEnd (last)) << "," << mergeSum << std::endl;
+        }
+      out.close ();
+      return;
+    }
+
   int mergeNBins = (int)(writeBinWidth / m_binWidth);
 
+  if (m_sparseStorage)
+    {
+      // Same output as the dense loop below, only occupied bins are visited
+      uint32_t pos = 0;
+      while (pos < m_sparse.size ())
+        {
+          uint32_t group = m_sparse[pos].first / mergeNBins;
+          uint32_t mergeSum = 0;
+          while (pos < m_sparse.size () && m_sparse[pos].first / mergeNBins == group)
+            {
+              mergeSum += m_sparse[pos].second;
+              pos++;
+            }
+          out << GetBinStart (group * mergeNBins) + 0.5*(mergeNBins*m_binWidth) << "," << mergeSum << std::endl;
+        }
+      out.close ();
+      return;
+    }
+
   // Reformat hist for writing
-  uint32_t n = GetNBins ();
   uint32_t i = 0;
   uint32_t mergeSum=0;
   uint32_t mergeStartIndex=0, mergeStopIndex=0;
@@ -272,6 +637,83 @@ StatsHist::WriteToCsvFile (std::string fileName, double writeBinWidth, std::stri
 }
 
 
+void
+StatsHist::Serialize (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  uint8_t sparse = m_sparseStorage;
+  uint32_t unitLength = m_unit.size ();
+  os.write ((const char *)&m_binWidth, sizeof (m_binWidth));
+  os.write ((const char *)&m_subBucketBits, sizeof (m_subBucketBits));
+  os.write ((const char *)&sparse, sizeof (sparse));
+  os.write ((const char *)&unitLength, sizeof (unitLength));
+  os.write (m_unit.c_str (), unitLength);
+  const double values[] = {m_total, m_squareTotal, m_min, m_max, m_meanCurr, m_sCurr, m_varianceCurr, m_meanPrev, m_sPrev};
+  int64_t count = m_count;
+  os.write ((const char *)&count, sizeof (count));
+  os.write ((const char *)values, sizeof (values));
+
+  // occupied bins only, as (index, count) pairs
+  uint32_t nOccupied = 0;
+  for (uint32_t pos = 0; pos < GetNStored (); ++pos)
+    {
+      nOccupied += GetStoredCount (pos) > 0;
+    }
+  os.write ((const char *)&nOccupied, sizeof (nOccupied));
+  for (uint32_t pos = 0; pos < GetNStored (); ++pos)
+    {
+      uint32_t bin[2] = {GetStoredIndex (pos), GetStoredCount (pos)};
+      if (bin[1] > 0)
+        {
+          os.write ((const char *)bin, sizeof (bin));
+        }
+    }
+}
+
+bool
+StatsHist::Deserialize (std::istream &is)
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+  uint8_t sparse = 0;
+  uint32_t unitLength = 0;
+  is.read ((char *)&m_binWidth, sizeof (m_binWidth));
+  is.read ((char *)&m_subBucketBits, sizeof (m_subBucketBits));
+  is.read ((char *)&sparse, sizeof (sparse));
+  is.read ((char *)&unitLength, sizeof (unitLength));
+  if (!is || unitLength > 1024)
+    {
+      return false;
+    }
+  m_sparseStorage = sparse;
+  m_unit.assign (unitLength, ' ');
+  is.read (&m_unit[0], unitLength);
+  double values[9];
+  int64_t count = 0;
+  is.read ((char *)&count, sizeof (count));
+  is.read ((char *)values, sizeof (values));
+  m_count = count;
+  m_total = values[0];
+  m_squareTotal = values[1];
+  m_min = values[2];
+  m_max = values[3];
+  m_meanCurr = values[4];
+  m_sCurr = values[5];
+  m_varianceCurr = values[6];
+  m_meanPrev = values[7];
+  m_sPrev = values[8];
+
+  uint32_t nOccupied = 0;
+  is.read ((char *)&nOccupied, sizeof (nOccupied));
+  for (uint32_t i = 0; i < nOccupied && is; ++i)
+    {
+      uint32_t bin[2];
+      is.read ((char *)bin, sizeof (bin));
+      AddToBin (bin[0], bin[1]); // stored in increasing index order
+    }
+  return (bool)is;
+}
+
 } // namespace ns3
 
 
@@ -26,8 +26,10 @@
 #include <vector>
 #include <stdint.h>
 #include <ostream>
+#include <istream>
 #include <cmath>
 #include <string>
+#include <utility>
 
 namespace ns3 {
 
@@ -39,6 +41,19 @@ namespace ns3 {
  * Hence, bin \a i groups the data from [i*binWidth, (i+1)binWidth).
  *
  * This class only handles \a positive bins, i.e., it does \a not handles negative data.
+ *
+ * Log-linear layout (SetLogLinear ()): values are counted in units of binWidth
+ * and the first 2^(subBucketBits+1) bins are one unit wide. Above that every
+ * power of two range is split into 2^subBucketBits equal bins, so the bin width
+ * is at most 2^-subBucketBits of the value (constant relative precision) and
+ * the number of bins grows only with the logarithm of the largest value.
+ * With binWidth = 1 us and subBucketBits = 7 a 60 s delay needs about 2600 bins
+ * instead of 600000 bins of 0.1 ms in the fixed width layout.
+ *
+ * Sparse storage (SetSparse ()): only occupied bins are stored, as (index, count)
+ * pairs sorted by index, so memory is proportional to the number of occupied
+ * bins and not to the largest value. Bin indexes, results and CSV output are the
+ * same as with the dense storage, GetBinCount () is a binary search.
  */
 
 class StatsHist
@@ -80,9 +95,9 @@ public:
   /**
   * \brief Returns the bin width.
   *
-  * Note that all the bins have the same width.
+  * Note that all the bins have the same width in the fixed width layout.
+  * In the log-linear layout this is the width of the narrowest bins.
   *
-  * \param index the bin index
   * \return the bin width
   */
   double GetBinWidth () const;
@@ -94,6 +109,31 @@ public:
    * \param binWidth the bin width
    */
   void SetDefaultBinWidth (double binWidth);
+  /**
+   * \brief Switch between the fixed width and the log-linear layout.
+   *
+   * Note that you can change the layout only if the histogram is empty.
+   *
+   * \param subBucketBits 0 for fixed width bins, otherwise (1 to 16) relative
+   * precision of the log-linear layout is 2^-subBucketBits
+   */
+  void SetLogLinear (uint8_t subBucketBits);
+  uint8_t GetLogLinear () const { return m_subBucketBits; }
+  /**
+   * \brief Store only occupied bins (see class description).
+   *
+   * Note that you can change the storage only if the histogram is empty.
+   *
+   * \param sparse true for sparse, false for dense storage (default)
+   */
+  void SetSparse (bool sparse);
+  bool IsSparse () const { return m_sparseStorage; }
+  /**
+   * \brief Returns the width of the bin that would hold the value
+   * \param value the value
+   * \return the bin width at the value (bin width for the fixed width layout)
+   */
+  double GetResolution (double value) const;
   /**
    * \brief Get the number of data added to the bin.
    * \param index the bin index
@@ -108,11 +148,41 @@ public:
    */
   void AddValue (double value);
 
+  /**
+   * \brief Add all values of another histogram (e.g. of another flow, run or worker)
+   *
+   * Count, sum, min, max, mean and variance are combined exactly (mean and
+   * variance with the pairwise update of Chan et al.). Bins are added directly
+   * when both histograms have the same layout. If both have fixed width bins and
+   * the other one is coarser, this histogram is first re-binned to the other
+   * bin width. In all other cases every bin of the other histogram is added to
+   * the bin of this histogram that holds its middle. An empty histogram takes
+   * the layout of the other one.
+   *
+   * \param other the histogram to add
+   */
+  void Merge (const StatsHist &other);
+
   /**
    * \brief Provides raw estimate of the median based on histogram
    * \return estimated value of median
    */
   double GetMedianEstimation () const;
+  /**
+   * \brief Returns the q-quantile, interpolated inside the bin that holds it
+   *
+   * The first call after new values were added builds the cumulative bin counts
+   * (one pass over bins), every next call is a binary search, O(log bins).
+   *
+   * \param q the quantile, 0 <= q <= 1 (e.g. 0.99 for the 99th percentile)
+   * \return estimated value of the quantile (0 if the histogram is empty)
+   */
+  double GetQuantile (double q) const;
+  /**
+   * \brief Returns the memory used by the histogram
+   * \return number of bytes (object and bin storage)
+   */
+  uint32_t GetMemoryUsage () const;
 
   /**
    * \brief Returns the data count
@@ -159,9 +229,55 @@ public:
    */
   void WriteToCsvFile (std::string fileName, double writeBinWidth, std::string description = "Hist Data:") const;
 
+  /**
+   * \brief Write the complete histogram state (layout, statistics and occupied bins)
+   * in host byte order, e.g. to pass it to another process of the same program
+   * \param os the output stream
+   */
+  void Serialize (std::ostream &os) const;
+  /**
+   * \brief Restore the histogram written by Serialize ()
+   * \param is the input stream
+   * \return false if the stream ended before the whole histogram was read
+   */
+  bool Deserialize (std::istream &is);
+
 private:
-  std::vector<uint32_t> m_histogram; //!< Histogram data
-  double m_binWidth; //!< Bin width
+  /**
+   * \brief Returns the index of the bin that holds the value
+   * \param value the value
+   * \return the bin index
+   */
+  uint32_t GetIndex (double value) const;
+  /**
+   * \brief GetMedianEstimation for the sparse storage
+   * \return estimated value of median
+   */
+  double GetSparseMedianEstimation () const;
+  /**
+   * \brief Add count to the bin (dense or sparse storage)
+   * \param index the bin index
+   * \param count the count to add
+   */
+  void AddToBin (uint32_t index, uint32_t count);
+  /// Number of stored bins (all bins for dense, occupied bins for sparse storage)
+  uint32_t GetNStored () const { return m_sparseStorage ? m_sparse.size () : m_histogram.size (); }
+  /// Bin index of the stored bin at position pos
+  uint32_t GetStoredIndex (uint32_t pos) const { return m_sparseStorage ? m_sparse[pos].first : pos; }
+  /// Count of the stored bin at position pos
+  uint32_t GetStoredCount (uint32_t pos) const { return m_sparseStorage ? m_sparse[pos].second : m_histogram[pos]; }
+  /**
+   * \brief Re-bin fixed width histogram to a wider bin width
+   * \param binWidth the new bin width
+   */
+  void Rebin (double binWidth);
+
+  std::vector<uint32_t> m_histogram; //!< Histogram data (dense storage)
+  std::vector<std::pair<uint32_t, uint32_t> > m_sparse; //!< Occupied bins (index, count) sorted by index (sparse storage)
+  mutable std::vector<uint64_t> m_cumulative; //!< Cumulative counts of stored bins for GetQuantile, valid while last element == m_count
+  double m_binWidth; //!< Bin width (unit of the log-linear layout)
+  uint8_t m_subBucketBits; //!< 0 for fixed width layout, log2 of sub-buckets per power of two otherwise
+  bool m_sparseStorage; //!< Only occupied bins are stored (m_sparse instead of m_histogram)
   std::string m_unit;
 
   long m_count;      //!< Count value
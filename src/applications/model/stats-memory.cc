@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <sys/resource.h>
+
+#include "ns3/log.h"
+#include "ns3/stats-memory.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsMemory");
+
+namespace {
+
+// Value of a "<field>:   <n> kB" line of /proc/self/status [B], 0 if not found
+uint64_t
+ReadProcStatus (const char *field)
+{
+  FILE *f = std::fopen ("/proc/self/status", "r");
+  if (f == 0)
+    {
+      return 0;
+    }
+  char line[256];
+  size_t fieldLength = std::strlen (field);
+  unsigned long long kb = 0;
+  while (std::fgets (line, sizeof (line), f))
+    {
+      if (std::strncmp (line, field, fieldLength) == 0 && line[fieldLength] == ':')
+        {
+          std::sscanf (line + fieldLength + 1, "%llu", &kb);
+          break;
+        }
+    }
+  std::fclose (f);
+  return (uint64_t)kb * 1024;
+}
+
+} // anonymous namespace
+
+uint64_t
+StatsMemory::GetRss ()
+{
+  return ReadProcStatus ("VmRSS");
+}
+
+uint64_t
+StatsMemory::GetPeakRss ()
+{
+  uint64_t peak = ReadProcStatus ("VmHWM");
+  if (peak == 0)
+    {
+      struct rusage usage;
+      if (getrusage (RUSAGE_SELF, &usage) == 0)
+        {
+          peak = (uint64_t)usage.ru_maxrss * 1024; // kB on Linux and BSD
+        }
+    }
+  return peak;
+}
+
+bool
+StatsMemory::ResetPeakRss ()
+{
+  FILE *f = std::fopen ("/proc/self/clear_refs", "w");
+  if (f == 0)
+    {
+      return false;
+    }
+  bool ok = std::fputs ("5", f) >= 0; // 5: reset the peak RSS (Linux 4.0 and later)
+  ok = std::fclose (f) == 0 && ok;
+  NS_LOG_LOGIC ("Peak RSS reset: " << ok);
+  return ok;
+}
+
+} // namespace ns3
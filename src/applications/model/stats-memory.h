@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+
+#ifndef STATS_MEMORY_H
+#define STATS_MEMORY_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief Resident memory (RSS) of this process, for memory reports of simulation runs.
+ *
+ * On Linux the values are read from /proc/self/status and the peak can be reset
+ * before every run (/proc/self/clear_refs), so GetPeakRss () is the peak of the run.
+ * Elsewhere the peak is the peak of the process (getrusage) and GetRss () is 0.
+ */
+class StatsMemory
+{
+public:
+  /// \return current resident memory [B]
+  static uint64_t GetRss ();
+  /// \return peak resident memory since the process start or the last ResetPeakRss () [B]
+  static uint64_t GetPeakRss ();
+  /**
+   * \brief Set the peak to the current resident memory
+   * \return false if the peak cannot be reset on this system
+   */
+  static bool ResetPeakRss ();
+};
+
+} // namespace ns3
+
+#endif /* STATS_MEMORY_H */
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <map>
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/pointer.h"
+#include "ns3/stats-overhead.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsOverheadCollector");
+
+StatsOverheadCollector::StatsOverheadCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+StatsOverheadCollector::AttachAll (std::string traceSource)
+{
+  NS_LOG_FUNCTION (this << traceSource);
+  uint32_t n = 0;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t d = 0; d < (*node)->GetNDevices (); ++d)
+        {
+          if (AttachDevice ((*node)->GetDevice (d), traceSource))
+            {
+              n++;
+            }
+        }
+    }
+  NS_LOG_INFO ("Devices attached to " << traceSource << ": " << n);
+  return n;
+}
+
+bool
+StatsOverheadCollector::AttachDevice (Ptr<NetDevice> device, std::string traceSource)
+{
+  NS_LOG_FUNCTION (this << device << traceSource);
+  uint32_t nodeId = device->GetNode ()->GetId ();
+  if (AttachObject (device, traceSource, nodeId, device->GetIfIndex ()))
+    {
+      return true;
+    }
+  // devices without the trace source, e.g. WifiNetDevice: the trace source
+  // of the PHY object (the "Phy" attribute of the device)
+  PointerValue phy;
+  if (device->GetAttributeFailSafe ("Phy", phy) && phy.Get<Object> () != 0
+      && AttachObject (phy.Get<Object> (), traceSource, nodeId, device->GetIfIndex ()))
+    {
+      NS_LOG_LOGIC ("Node " << nodeId << " device " << device->GetIfIndex () << ": " << traceSource << " of the Phy attached");
+      return true;
+    }
+  return false;
+}
+
+bool
+StatsOverheadCollector::AttachObject (Ptr<Object> object, std::string traceSource, uint32_t nodeId, uint32_t deviceId)
+{
+  // The callback signature differs between objects and ns-3 releases, a callback
+  // of the wrong type would be a fatal error, so it is chosen by the declared signature
+  struct TypeId::TraceSourceInformation info;
+  if (!object->GetInstanceTypeId ().LookupTraceSourceByName (traceSource, &info))
+    {
+      return false;
+    }
+  uint32_t index = m_counters.size ();
+  m_counters.push_back (DeviceCounter (nodeId, deviceId));
+  bool connected = false;
+  if (info.callback == "ns3::Packet::TracedCallback")
+    {
+      // CSMA, point-to-point (device), Wi-Fi PHY up to ns-3.29
+      connected = object->TraceConnectWithoutContext (traceSource, MakeBoundCallback (&StatsOverheadCollector::CountTx<Ptr<const Packet> >, &m_counters, index));
+    }
+  else if (info.callback == "ns3::WifiPhy::PhyTxBeginTracedCallback")
+    {
+      // Wi-Fi PHY since ns-3.30 (packet, TX power in W)
+      connected = object->TraceConnectWithoutContext (traceSource, MakeBoundCallback (&StatsOverheadCollector::CountTx<Ptr<const Packet>, double>, &m_counters, index));
+    }
+  else
+    {
+      NS_LOG_WARN ("Node " << nodeId << " device " << deviceId << ": " << traceSource
+                           << " has an unknown signature " << info.callback << ", not attached");
+    }
+  if (!connected)
+    {
+      m_counters.pop_back ();
+    }
+  return connected;
+}
+
+uint64_t
+StatsOverheadCollector::GetTxPackets () const
+{
+  uint64_t txPackets = 0;
+  for (uint32_t i = 0; i < m_counters.size (); ++i)
+    {
+      txPackets += m_counters[i].txPackets;
+    }
+  return txPackets;
+}
+
+uint64_t
+StatsOverheadCollector::GetTxBytes () const
+{
+  uint64_t txBytes = 0;
+  for (uint32_t i = 0; i < m_counters.size (); ++i)
+    {
+      txBytes += m_counters[i].txBytes;
+    }
+  return txBytes;
+}
+
+double
+StatsOverheadCollector::GetPhyOverAppRatio (uint64_t appTxBytes) const
+{
+  uint64_t txBytes = GetTxBytes ();
+  if (txBytes == 0)
+    {
+      return 0.0;
+    }
+  return (double)appTxBytes / (double)txBytes * 100.0;
+}
+
+void
+StatsOverheadCollector::WritePerNode (std::ostream &out) const
+{
+  // all devices of a node are summed
+  std::map<uint32_t, DeviceCounter> perNode;
+  for (uint32_t i = 0; i < m_counters.size (); ++i)
+    {
+      DeviceCounter &node = perNode[m_counters[i].nodeId];
+      node.txPackets += m_counters[i].txPackets;
+      node.txBytes += m_counters[i].txBytes;
+    }
+  for (std::map<uint32_t, DeviceCounter>::const_iterator it = perNode.begin (); it != perNode.end (); ++it)
+    {
+      out << it->first << "," << it->second.txPackets << "," << it->second.txBytes << std::endl;
+    }
+}
+
+void
+StatsOverheadCollector::Reset ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_counters.size (); ++i)
+    {
+      m_counters[i].txPackets = 0; // callbacks stay connected
+      m_counters[i].txBytes = 0;
+    }
+}
+
+} // namespace ns3
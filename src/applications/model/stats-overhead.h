@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef STATS_OVERHEAD_H
+#define STATS_OVERHEAD_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdio>
+#include <stdint.h>
+
+#include "ns3/ptr.h"
+#include "ns3/callback.h"
+#include "ns3/config.h"
+#include "ns3/net-device.h"
+
+namespace ns3 {
+
+/**
+ * \brief Counts packets and bytes sent by network devices, for any link technology.
+ *
+ * Every attached device gets one counter in a flat array and its trace source
+ * is connected without context to a callback bound to the counter index,
+ * so a transmission only increments two integers (no context string, no lookup).
+ *
+ * AttachAll () connects a trace source with the Ptr<const Packet> signature
+ * that is found on the NetDevice itself ("PhyTxBegin" or "MacTx" of CSMA,
+ * point-to-point and similar devices). A device without that trace source
+ * is attached to the trace source of the same name of its "Phy" attribute
+ * object, so Wi-Fi devices are counted by the WifiPhy "PhyTxBegin" (the
+ * signature of every ns-3 release is recognized, no Wi-Fi headers are needed).
+ * Other devices are skipped. Trace sources with other signatures or on other
+ * objects below the device are attached with AttachPath ():
+ *
+ * \code
+ *   collector.AttachPath<Ptr<const Packet>, WifiMode, WifiPreamble, uint8_t> ("/NodeList/ * /DeviceList/ * /Phy/State", "Tx");
+ * \endcode
+ *
+ * The first trace argument only has to provide GetSize () (Packet, PacketBurst).
+ * A device attached to two trace sources is counted twice.
+ */
+class StatsOverheadCollector
+{
+public:
+  /// Transmissions of one attached device
+  struct DeviceCounter
+  {
+    DeviceCounter (uint32_t node = 0, uint32_t device = 0)
+      : nodeId (node),
+        deviceId (device),
+        txPackets (0),
+        txBytes (0)
+    {};
+
+    uint32_t nodeId;
+    uint32_t deviceId;
+    uint64_t txPackets;
+    uint64_t txBytes;
+  };
+
+  StatsOverheadCollector ();
+
+  /**
+   * \brief Attach the given trace source of every device of every node
+   * \param traceSource NetDevice trace source with the Ptr<const Packet> signature
+   * \return number of attached devices
+   */
+  uint32_t AttachAll (std::string traceSource = "PhyTxBegin");
+  /**
+   * \brief Attach the given trace source of one device, or of its "Phy" object
+   * \param device the device
+   * \param traceSource NetDevice (or PHY) trace source with the Ptr<const Packet> signature
+   * \return true if the device or its PHY has the trace source
+   */
+  bool AttachDevice (Ptr<NetDevice> device, std::string traceSource = "PhyTxBegin");
+  /**
+   * \brief Attach a trace source of every object matched by a config path
+   * below "/NodeList/<node>/DeviceList/<device>". Template arguments are the trace
+   * source arguments, the first one is the transmitted packet.
+   * \param objectPath config path of the objects owning the trace source
+   * \param traceSource the trace source name
+   * \return number of attached objects
+   */
+  template <typename P, typename... Rest>
+  uint32_t AttachPath (std::string objectPath, std::string traceSource);
+
+  uint32_t GetNDevices () const { return m_counters.size (); };
+  const std::vector<DeviceCounter> & GetCounters () const { return m_counters; };
+  uint64_t GetTxPackets () const;
+  uint64_t GetTxBytes () const;
+  /**
+   * \param appTxBytes application bytes sent in the same period
+   * \return application bytes as a percentage of all transmitted bytes
+   * (the "PHY over APP traffic ratio" of the scalar file), 0 if nothing was transmitted
+   */
+  double GetPhyOverAppRatio (uint64_t appTxBytes) const;
+
+  /**
+   * \brief Write transmitted packets and bytes summed per node, one line per node
+   * \param out the output stream
+   */
+  void WritePerNode (std::ostream &out) const;
+
+  /**
+   * \brief Zero all counters (devices stay attached)
+   */
+  void Reset ();
+  /**
+   * \brief Forget all devices. Their trace sources stay connected, so this is
+   * only for devices that are destroyed (e.g. after Simulator::Destroy ()).
+   */
+  void Clear () { m_counters.clear (); };
+
+  /**
+   * \brief Trace sink connected by the Attach functions, bound to one counter
+   * \param counters the counter array
+   * \param i index of the device counter
+   * \param packet the transmitted packet (or packet burst)
+   */
+  template <typename P, typename... Rest>
+  static void CountTx (std::vector<DeviceCounter> *counters, uint32_t i, P packet, Rest...);
+
+private:
+  /**
+   * \brief Attach a trace source of a device or PHY object, by its callback signature
+   * \param object the object owning the trace source
+   * \param traceSource the trace source name
+   * \param nodeId node of the device
+   * \param deviceId the device index
+   * \return true if the trace source exists and has a known signature
+   */
+  bool AttachObject (Ptr<Object> object, std::string traceSource, uint32_t nodeId, uint32_t deviceId);
+
+  std::vector<DeviceCounter> m_counters; //!< One per attached trace source (callbacks keep the index)
+};
+
+template <typename P, typename... Rest>
+void
+StatsOverheadCollector::CountTx (std::vector<DeviceCounter> *counters, uint32_t i, P packet, Rest...)
+{
+  DeviceCounter &counter = (*counters)[i];
+  counter.txPackets++;
+  counter.txBytes += packet->GetSize ();
+}
+
+template <typename P, typename... Rest>
+uint32_t
+StatsOverheadCollector::AttachPath (std::string objectPath, std::string traceSource)
+{
+  // The path is resolved once, every matched object is then connected without context
+  Config::MatchContainer matches = Config::LookupMatches (objectPath);
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < matches.GetN (); ++i)
+    {
+      unsigned int nodeId = 0, deviceId = 0;
+      std::sscanf (matches.GetMatchedPath (i).c_str (), "/NodeList/%u/DeviceList/%u", &nodeId, &deviceId);
+      uint32_t index = m_counters.size ();
+      m_counters.push_back (DeviceCounter (nodeId, deviceId));
+      if (matches.Get (i)->TraceConnectWithoutContext (traceSource, MakeBoundCallback (&StatsOverheadCollector::CountTx<P, Rest...>, &m_counters, index)))
+        {
+          n++;
+        }
+      else
+        {
+          m_counters.pop_back ();
+        }
+    }
+  return n;
+}
+
+} // namespace ns3
+
+#endif /* STATS_OVERHEAD_H */
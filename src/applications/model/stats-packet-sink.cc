@@ -67,6 +67,10 @@ StatsPacketSink::GetTypeId (void)
                      "A packet has been received",
                      MakeTraceSourceAccessor (&StatsPacketSink::m_rxTrace),
                      "ns3::StatsPacketSink::StatsTracedCallback")
+    .AddTraceSource ("RxRecord",
+                     "A packet has been received, StatsHeader fields already decoded",
+                     MakeTraceSourceAccessor (&StatsPacketSink::m_rxRecordTrace),
+                     "ns3::StatsPacketSink::RecordTracedCallback")
     //***************************************************************************
   ;
   return tid;
@@ -75,7 +79,8 @@ StatsPacketSink::GetTypeId (void)
 StatsPacketSink::StatsPacketSink () 
   : m_socket (0), 
     m_totalRx (0),
-    m_totalPacketsRx (0)
+    m_totalPacketsRx (0),
+    m_applicationListIndex (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -217,6 +222,16 @@ void StatsPacketSink::HandleRead (Ptr<Socket> socket)
       
       //*** This sholud be added in any other application to use with StatsData ***
       m_rxTrace (packet, GetNode ()->GetId (), m_applicationListIndex, from);
+      // the header is decoded once here for all RxRecord listeners, and only if there are any
+      if (!m_rxRecordTrace.IsEmpty ())
+        {
+          StatsHeader statsHeader;
+          packet->PeekHeader (statsHeader);
+          StatsPacketInfo info;
+          statsHeader.GetPacketInfo (info);
+          info.size = packet->GetSize ();
+          m_rxRecordTrace (info, GetNode ()->GetId (), m_applicationListIndex, from);
+        }
       //***************************************************************************
     }
 }
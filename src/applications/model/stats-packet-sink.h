@@ -31,6 +31,7 @@
 #include "ns3/traced-callback.h"
 #include "ns3/address.h"
 #include "ns3/stats-data.h"
+#include "ns3/stats-header.h"
 
 namespace ns3 {
 
@@ -76,6 +77,8 @@ public:
   //*** This sholud be added in any other application to use with StatsData ***
   typedef void (* StatsTracedCallback)
     (Ptr<const Packet> packet, uint32_t sinkNodeId, uint32_t sinkAppId, Address sourceAddr);
+  typedef void (* RecordTracedCallback)
+    (const StatsPacketInfo &info, uint32_t sinkNodeId, uint32_t sinkAppId, const Address &sourceAddr);
   //***************************************************************************
 
   /**
@@ -144,6 +147,8 @@ private:
   //*** This sholud be added in any other application to use with StatsData ***
   // Traced Callback: received packet, sink node ID in NodeList, sink app index in ApplicationList, soource address.
   TracedCallback<Ptr<const Packet>, uint32_t, uint32_t, Address> m_rxTrace;
+  // Traced Callback: decoded StatsHeader of the received packet, sink node ID, sink app index, source address.
+  TracedCallback<const StatsPacketInfo &, uint32_t, uint32_t, const Address &> m_rxRecordTrace;
   uint32_t m_applicationListIndex;
   //***************************************************************************
 };
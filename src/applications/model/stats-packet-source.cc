@@ -93,7 +93,22 @@ StatsPacketSource::GetTypeId (void)
     //*** This sholud be added in any other application to use with StatsData ***
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&StatsPacketSource::m_txTrace),
-                     "ns3::Packet::TracedCallback")
+                     "ns3::StatsPacketSource::TxTracedCallback")
+    .AddTraceSource ("TxRecord", "A new packet is created and is sent, StatsHeader fields already known",
+                     MakeTraceSourceAccessor (&StatsPacketSource::m_txRecordTrace),
+                     "ns3::StatsPacketSource::RecordTracedCallback")
+    .AddAttribute ("CompactHeader",
+                   "Send the compact StatsHeader (flow id, varint sequence number and time stamp offset, "
+                   "about 10 bytes) instead of the full one (27 bytes for IPv4, 39 bytes for IPv6).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&StatsPacketSource::m_compactHeader),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FlowSlot",
+                   "Flow id registered for this application at install time (StatsHeader::RegisterFlow), "
+                   "set by StatsSourceHelper::SetFlowBinding. Implies the compact StatsHeader.",
+                   UintegerValue (StatsPacketInfo::NO_FLOW_SLOT),
+                   MakeUintegerAccessor (&StatsPacketSource::m_flowSlot),
+                   MakeUintegerChecker<uint32_t> ())
     //***************************************************************************
   ;
   return tid;
@@ -106,7 +121,12 @@ StatsPacketSource::StatsPacketSource ()
     m_residualBits (0),
     m_lastStartTime (Seconds (0)),
     m_totBytes (0),
-    m_sent (0)
+    m_sent (0),
+    m_applicationListIndex (0),
+    m_sinkKey (0),
+    m_compactHeader (false),
+    m_compactFlowId (0),
+    m_flowSlot (StatsPacketInfo::NO_FLOW_SLOT)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -201,6 +221,18 @@ void StatsPacketSource::StartApplication () // Called at time specified by Start
       break;
     }
   }
+  m_sinkKey = StatsHeader::GetSinkKey (m_peer);
+  if (m_flowSlot != StatsPacketInfo::NO_FLOW_SLOT)
+    {
+      // flow registered by the helper, packets carry the flow slot in the compact header
+      NS_ASSERT_MSG (m_flowSlot < StatsHeader::GetNRegisteredFlows (), "FlowSlot " << m_flowSlot << " is not registered");
+      m_compactHeader = true;
+      m_compactFlowId = m_flowSlot;
+    }
+  else if (m_compactHeader)
+    {
+      m_compactFlowId = StatsHeader::RegisterFlow (n->GetId (), m_applicationListIndex, m_peer, Simulator::Now ());
+    }
   //****************************************************************************
 }
 
@@ -304,6 +336,10 @@ void StatsPacketSource::SendPacket ()
   statsHeader.SetNodeId (GetNode ()->GetId ());
   statsHeader.SetApplicationId (m_applicationListIndex);
   statsHeader.SetRxAddress (m_peer);
+  if (m_compactHeader)
+    {
+      statsHeader.SetCompact (m_compactFlowId);
+    }
   Ptr<Packet> packet = Create<Packet> (m_pktSize-(statsHeader.GetSerializedSize ())); //  the size of the packet minus the size of the statsHeader header
   packet->AddHeader (statsHeader);
   //***********************************************************************************
@@ -335,6 +371,15 @@ void StatsPacketSource::SendPacket ()
     }
   
   m_txTrace (packet); // This sholud be added/changed in any other application to use with StatsData
+  StatsPacketInfo info;
+  info.seq = m_sent - 1;
+  info.txTimeStep = statsHeader.GetTs ().GetTimeStep ();
+  info.sourceNodeId = GetNode ()->GetId ();
+  info.sourceAppId = m_applicationListIndex;
+  info.sinkKey = m_sinkKey;
+  info.size = packet->GetSize ();
+  info.flowSlot = m_compactHeader ? m_compactFlowId : StatsPacketInfo::NO_FLOW_SLOT;
+  m_txRecordTrace (info);
   NS_LOG_INFO ("Sent packet's header: " << statsHeader.ToString ());
   
   m_lastStartTime = Simulator::Now ();
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
+#include "ns3/stats-header.h"
 #include <string>
 
 namespace ns3 {
@@ -93,6 +94,11 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  //*** This sholud be added in any other application to use with StatsData ***
+  typedef void (* TxTracedCallback) (Ptr<const Packet> packet);
+  typedef void (* RecordTracedCallback) (const StatsPacketInfo &info);
+  //***************************************************************************
+
   StatsPacketSource ();
 
   virtual ~StatsPacketSource();
@@ -193,7 +199,13 @@ private:
   //*** This sholud be added in any other application to use with StatsData ***
   // Traced Callback: sent packet.
   TracedCallback<Ptr<const Packet> > m_txTrace;
+  // Traced Callback: StatsHeader fields of the sent packet.
+  TracedCallback<const StatsPacketInfo &> m_txRecordTrace;
   uint32_t m_applicationListIndex;
+  uint64_t m_sinkKey; //!< m_peer packed by StatsHeader::GetSinkKey
+  bool m_compactHeader; //!< Send compact StatsHeader
+  uint32_t m_compactFlowId; //!< Flow id registered for the compact StatsHeader
+  uint32_t m_flowSlot; //!< Flow id registered at install time (StatsSourceHelper::SetFlowBinding)
   //***************************************************************************
 
 };
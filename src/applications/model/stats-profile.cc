@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include "ns3/stats-profile.h"
+
+#ifdef STATS_PROFILING
+
+namespace ns3 {
+
+StatsProfile::StatsProfile ()
+{
+  Clear ();
+}
+
+void
+StatsProfile::Clear ()
+{
+  for (uint32_t f = 0; f < N_FUNCTIONS; ++f)
+    {
+      m_calls[f] = 0;
+      m_ticks[f] = 0;
+    }
+  for (uint32_t c = 0; c < N_COUNTERS; ++c)
+    {
+      m_counters[c] = 0;
+    }
+  m_startTicks = GetTicks ();
+  m_startTime = std::chrono::steady_clock::now ();
+}
+
+void
+StatsProfile::Write (std::ostream &out, uint64_t deviceTxCalls, uint64_t vectorFileBytes) const
+{
+  // ticks per second over the profiled period (time stamp counter frequency)
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_startTime).count ();
+  double ticksPerSecond = seconds > 0 ? (GetTicks () - m_startTicks) / seconds : 1e9;
+  const char *names[N_FUNCTIONS] = {"StatsFlows::TxRecord (packet sent)", "StatsFlows::RxRecord (packet received)",
+                                    "FlowData::PacketReceived"};
+  out << "PROFILE (inclusive times), Calls, Time [ms], Time per call [ns]" << std::endl;
+  for (uint32_t f = 0; f < N_FUNCTIONS; ++f)
+    {
+      double time = m_ticks[f] / ticksPerSecond;
+      out << names[f] << "," << m_calls[f] << "," << time * 1e3 << "," << (m_calls[f] > 0 ? time * 1e9 / m_calls[f] : 0.0) << std::endl;
+    }
+  out << "StatsOverheadCollector device Tx (not timed)," << deviceTxCalls << std::endl;
+  out << "Flow lookups by flow slot:," << m_counters[SLOT_LOOKUPS] << std::endl;
+  out << "Flow lookups in the hash table:," << m_counters[HASH_LOOKUPS] << std::endl;
+  out << "Hash table entries probed:," << m_counters[HASH_PROBES] << std::endl;
+  out << "Flow histogram reallocations:," << m_counters[HIST_RESIZES] << std::endl;
+  out << "Vector file bytes written:," << vectorFileBytes << std::endl;
+}
+
+} // namespace ns3
+
+#endif /* STATS_PROFILING */
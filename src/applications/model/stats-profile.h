@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+
+#ifndef STATS_PROFILE_H
+#define STATS_PROFILE_H
+
+/**
+ * Self-profiling of the StatsFlows hot path. Built only when STATS_PROFILING
+ * is defined (./waf configure --enable-stats-profiling); otherwise the macros
+ * below expand to nothing and StatsFlows has no profiling members.
+ *
+ * STATS_PROFILE_SCOPE (profile, FUNCTION) times the rest of the enclosing block,
+ * STATS_PROFILE_COUNT (profile, COUNTER, n) adds n to a counter and
+ * STATS_PROFILE (statement) is a statement needed only for profiling.
+ */
+#ifdef STATS_PROFILING
+
+#include <ostream>
+#include <chrono>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace ns3 {
+
+/**
+ * \brief Calls, time and event counters of the StatsFlows packet callbacks
+ */
+class StatsProfile
+{
+public:
+  /// Profiled functions (times are inclusive: RX_RECORD includes FLOW_PACKET_RECEIVED)
+  enum Function
+  {
+    TX_RECORD,            //!< StatsFlows::TxRecord (packet sent)
+    RX_RECORD,            //!< StatsFlows::RxRecord (packet received)
+    FLOW_PACKET_RECEIVED, //!< FlowData::PacketReceived (per-flow statistics and histogram)
+    N_FUNCTIONS
+  };
+  /// Event counters
+  enum Counter
+  {
+    SLOT_LOOKUPS,  //!< Flows found by the flow slot of the packet
+    HASH_LOOKUPS,  //!< Flows looked up in the flow hash table
+    HASH_PROBES,   //!< Entries of the hash table buckets searched by the lookups
+    HIST_RESIZES,  //!< Reallocations of per-flow histogram storage
+    N_COUNTERS
+  };
+
+  StatsProfile ();
+  void Clear ();
+
+  /// \return time stamp counter (x86) or steady_clock nanoseconds
+  static uint64_t GetTicks ()
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc ();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+#endif
+  };
+  void AddCall (Function function, uint64_t ticks) { m_calls[function]++; m_ticks[function] += ticks; };
+  void Count (Counter counter, uint64_t n) { m_counters[counter] += n; };
+
+  /**
+   * \brief Write the cost breakdown, one line per function and counter
+   * \param out the output stream
+   * \param deviceTxCalls device Tx callbacks (StatsOverheadCollector, counted but not timed)
+   * \param vectorFileBytes bytes written to the vector file
+   */
+  void Write (std::ostream &out, uint64_t deviceTxCalls, uint64_t vectorFileBytes) const;
+
+  /// Times the enclosing block
+  class Scope
+  {
+  public:
+    Scope (StatsProfile &profile, Function function)
+      : m_profile (profile),
+        m_function (function),
+        m_start (GetTicks ())
+    {};
+    ~Scope () { m_profile.AddCall (m_function, GetTicks () - m_start); };
+  private:
+    StatsProfile &m_profile;
+    Function m_function;
+    uint64_t m_start;
+  };
+
+private:
+  uint64_t m_calls[N_FUNCTIONS];
+  uint64_t m_ticks[N_FUNCTIONS];
+  uint64_t m_counters[N_COUNTERS];
+  uint64_t m_startTicks; //!< Ticks at Clear (), to convert ticks to seconds
+  std::chrono::steady_clock::time_point m_startTime;
+};
+
+} // namespace ns3
+
+#define STATS_PROFILE_SCOPE(profile, function) ns3::StatsProfile::Scope statsProfileScope_ ## function (profile, ns3::StatsProfile::function)
+#define STATS_PROFILE_COUNT(profile, counter, n) (profile).Count (ns3::StatsProfile::counter, n)
+#define STATS_PROFILE(statement) statement
+
+#else /* STATS_PROFILING */
+
+#define STATS_PROFILE_SCOPE(profile, function)
+#define STATS_PROFILE_COUNT(profile, counter, n)
+#define STATS_PROFILE(statement)
+
+#endif /* STATS_PROFILING */
+
+#endif /* STATS_PROFILE_H */
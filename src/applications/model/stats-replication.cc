@@ -0,0 +1,377 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/stats-replication.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsReplication");
+
+namespace {
+
+// Continued fraction of the regularized incomplete beta function (modified Lentz's method)
+double
+BetaContinuedFraction (double a, double b, double x)
+{
+  const double tiny = 1e-300;
+  double c = 1.0;
+  double d = 1.0 - (a + b) * x / (a + 1.0);
+  d = 1.0 / (std::fabs (d) < tiny ? tiny : d);
+  double h = d;
+  for (uint32_t m = 1; m <= 300; ++m)
+    {
+      double m2 = 2.0 * m;
+      double aa = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+      d = 1.0 + aa * d;
+      d = 1.0 / (std::fabs (d) < tiny ? tiny : d);
+      c = 1.0 + aa / c;
+      c = std::fabs (c) < tiny ? tiny : c;
+      h *= d * c;
+      aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+      d = 1.0 + aa * d;
+      d = 1.0 / (std::fabs (d) < tiny ? tiny : d);
+      c = 1.0 + aa / c;
+      c = std::fabs (c) < tiny ? tiny : c;
+      double delta = d * c;
+      h *= delta;
+      if (std::fabs (delta - 1.0) < 1e-15)
+        {
+          break;
+        }
+    }
+  return h;
+}
+
+// Regularized incomplete beta function I_x (a, b)
+double
+IncompleteBeta (double a, double b, double x)
+{
+  if (x <= 0.0)
+    {
+      return 0.0;
+    }
+  if (x >= 1.0)
+    {
+      return 1.0;
+    }
+  double front = std::exp (std::lgamma (a + b) - std::lgamma (a) - std::lgamma (b) + a * std::log (x) + b * std::log (1.0 - x));
+  if (x < (a + 1.0) / (a + b + 2.0))
+    {
+      return front * BetaContinuedFraction (a, b, x) / a;
+    }
+  return 1.0 - front * BetaContinuedFraction (b, a, 1.0 - x) / b;
+}
+
+// P (T <= t) of the Student t distribution, t >= 0
+double
+StudentTCdf (double t, uint32_t dof)
+{
+  return 1.0 - 0.5 * IncompleteBeta (0.5 * dof, 0.5, dof / (dof + t * t));
+}
+
+} // anonymous namespace
+
+/*******************************************************
+ * StatsRunningStat
+ *******************************************************/
+StatsRunningStat::StatsRunningStat ()
+  : m_count (0),
+    m_mean (0),
+    m_m2 (0),
+    m_min (0),
+    m_max (0)
+{
+}
+
+void
+StatsRunningStat::Add (double value)
+{
+  m_count++;
+  double delta = value - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (value - m_mean);
+  if (m_count == 1 || value < m_min)
+    {
+      m_min = value;
+    }
+  if (m_count == 1 || value > m_max)
+    {
+      m_max = value;
+    }
+}
+
+void
+StatsRunningStat::Clear ()
+{
+  m_count = 0;
+  m_mean = 0;
+  m_m2 = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+double
+StatsRunningStat::GetVariance () const
+{
+  return m_count > 1 ? m_m2 / (m_count - 1) : 0.0;
+}
+
+double
+StatsRunningStat::GetStdDev () const
+{
+  return std::sqrt (GetVariance ());
+}
+
+double
+StatsRunningStat::GetHalfWidth (double level) const
+{
+  if (m_count < 2)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  return GetStudentTQuantile (0.5 + 0.5 * level, m_count - 1) * GetStdDev () / std::sqrt ((double)m_count);
+}
+
+double
+StatsRunningStat::GetRelativeHalfWidth (double level) const
+{
+  if (m_count < 2 || m_mean == 0.0)
+    {
+      return m_count > 1 && GetVariance () == 0.0 ? 0.0 : std::numeric_limits<double>::infinity ();
+    }
+  return GetHalfWidth (level) / std::fabs (m_mean);
+}
+
+double
+StatsRunningStat::GetStudentTQuantile (double p, uint32_t dof)
+{
+  NS_ASSERT_MSG (p > 0.0 && p < 1.0 && dof > 0, "Student t quantile needs 0 < p < 1 and dof > 0.");
+  if (p < 0.5)
+    {
+      return -GetStudentTQuantile (1.0 - p, dof);
+    }
+  // bisection on the distribution function (called once per run, precision matters more than speed)
+  double low = 0.0;
+  double high = 1.0;
+  while (StudentTCdf (high, dof) < p && high < 1e12)
+    {
+      high *= 2.0;
+    }
+  for (uint32_t i = 0; i < 200 && high - low > 1e-12 * high; ++i)
+    {
+      double middle = 0.5 * (low + high);
+      if (StudentTCdf (middle, dof) < p)
+        {
+          low = middle;
+        }
+      else
+        {
+          high = middle;
+        }
+    }
+  return 0.5 * (low + high);
+}
+
+/*******************************************************
+ * StatsReplicationControl
+ *******************************************************/
+StatsReplicationControl::StatsReplicationControl ()
+  : m_target (0.05),
+    m_level (0.95),
+    m_minRuns (3),
+    m_nRuns (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+StatsReplicationControl::SetTarget (double relativeHalfWidth, double level)
+{
+  NS_LOG_FUNCTION (this << relativeHalfWidth << level);
+  NS_ASSERT_MSG (relativeHalfWidth > 0.0 && level > 0.0 && level < 1.0, "Target half-width must be positive and confidence level between 0 and 1.");
+  m_target = relativeHalfWidth;
+  m_level = level;
+}
+
+void
+StatsReplicationControl::SetMinRuns (uint32_t minRuns)
+{
+  m_minRuns = minRuns < 2 ? 2 : minRuns;
+}
+
+bool
+StatsReplicationControl::AddMetric (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  std::string::size_type dot = name.find ('.');
+  std::string average = name.substr (0, dot);
+  uint32_t index = dot == std::string::npos ? Summary::N_VALUES : Summary::GetValueIndex (name.substr (dot + 1));
+  if ((average != "aap" && average != "aaf") || index == Summary::N_VALUES)
+    {
+      NS_LOG_WARN ("Unknown metric " << name << " (use aap.<value> or aaf.<value>)");
+      return false;
+    }
+  m_names.push_back (name);
+  m_allFlows.push_back (average == "aaf");
+  m_indexes.push_back (index);
+  m_stats.push_back (StatsRunningStat ());
+  return true;
+}
+
+bool
+StatsReplicationControl::ParseMetrics (std::string names)
+{
+  std::istringstream in (names);
+  std::string name;
+  bool ok = true;
+  while (std::getline (in, name, ','))
+    {
+      ok = AddMetric (name) && ok;
+    }
+  return ok && !m_names.empty ();
+}
+
+bool
+StatsReplicationControl::Add (const RunSummary &srs)
+{
+  m_nRuns++;
+  for (uint32_t m = 0; m < m_names.size (); ++m)
+    {
+      m_stats[m].Add ((m_allFlows[m] ? srs.aaf : srs.aap).GetValue (m_indexes[m]));
+    }
+  return IsConverged ();
+}
+
+bool
+StatsReplicationControl::IsConverged () const
+{
+  if (m_nRuns < m_minRuns || m_names.empty ())
+    {
+      return false;
+    }
+  for (uint32_t m = 0; m < m_stats.size (); ++m)
+    {
+      if (!(m_stats[m].GetRelativeHalfWidth (m_level) <= m_target))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+StatsReplicationControl::Clear ()
+{
+  m_nRuns = 0;
+  for (uint32_t m = 0; m < m_stats.size (); ++m)
+    {
+      m_stats[m].Clear ();
+    }
+}
+
+void
+StatsReplicationControl::WriteCsv (std::ostream &out) const
+{
+  for (uint32_t m = 0; m < m_stats.size (); ++m)
+    {
+      out << m_names[m] << "," << m_stats[m].GetCount () << "," << m_stats[m].GetMean () << ","
+          << m_stats[m].GetHalfWidth (m_level) << "," << m_stats[m].GetRelativeHalfWidth (m_level) << std::endl;
+    }
+}
+
+/*******************************************************
+ * StatsRunAggregator
+ *******************************************************/
+StatsRunAggregator::StatsRunAggregator ()
+  : m_values (2 * Summary::N_VALUES),
+    m_stats (2 * Summary::N_VALUES)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+StatsRunAggregator::GetSeries (bool allFlows, uint32_t value) const
+{
+  NS_ASSERT_MSG (value < Summary::N_VALUES, "No Summary value " << value);
+  return (allFlows ? Summary::N_VALUES : 0) + value;
+}
+
+void
+StatsRunAggregator::Add (uint64_t rngRun, const RunSummary &srs)
+{
+  NS_LOG_FUNCTION (this << rngRun);
+  m_rngRuns.push_back (rngRun);
+  for (uint32_t v = 0; v < Summary::N_VALUES; ++v)
+    {
+      double aap = srs.aap.GetValue (v);
+      double aaf = srs.aaf.GetValue (v);
+      m_values[GetSeries (false, v)].push_back (aap);
+      m_stats[GetSeries (false, v)].Add (aap);
+      m_values[GetSeries (true, v)].push_back (aaf);
+      m_stats[GetSeries (true, v)].Add (aaf);
+    }
+  m_delayHist.Merge (srs.delayHist);
+}
+
+void
+StatsRunAggregator::Clear ()
+{
+  m_rngRuns.clear ();
+  for (uint32_t s = 0; s < m_values.size (); ++s)
+    {
+      m_values[s].clear ();
+      m_stats[s].Clear ();
+    }
+  m_delayHist.Clear ();
+}
+
+const StatsRunningStat &
+StatsRunAggregator::GetStat (bool allFlows, uint32_t value) const
+{
+  return m_stats[GetSeries (allFlows, value)];
+}
+
+double
+StatsRunAggregator::GetMedian (bool allFlows, uint32_t value) const
+{
+  std::vector<double> values = m_values[GetSeries (allFlows, value)];
+  if (values.empty ())
+    {
+      return 0.0;
+    }
+  std::vector<double>::iterator middle = values.begin () + values.size () / 2;
+  std::nth_element (values.begin (), middle, values.end ());
+  if (values.size () % 2 == 1)
+    {
+      return *middle;
+    }
+  return 0.5 * (*middle + *std::max_element (values.begin (), middle));
+}
+
+} // namespace ns3
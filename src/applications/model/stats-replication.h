@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef STATS_REPLICATION_H
+#define STATS_REPLICATION_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+
+#include "ns3/stats-data.h"
+
+namespace ns3 {
+
+/**
+ * \brief Running mean, variance, min and max of one value across replications
+ * (Welford's update), with the Student-t confidence interval of the mean.
+ */
+class StatsRunningStat
+{
+public:
+  StatsRunningStat ();
+
+  void Add (double value);
+  void Clear ();
+
+  uint32_t GetCount () const { return m_count; };
+  double GetMean () const { return m_mean; };
+  /// \return sample variance (n - 1 in the denominator), 0 for less than two values
+  double GetVariance () const;
+  double GetStdDev () const;
+  double GetMin () const { return m_min; };
+  double GetMax () const { return m_max; };
+  /**
+   * \param level confidence level, e.g. 0.95
+   * \return half-width of the confidence interval of the mean, infinity for less than two values
+   */
+  double GetHalfWidth (double level) const;
+  /**
+   * \param level confidence level, e.g. 0.95
+   * \return half-width divided by |mean|, infinity for less than two values or zero mean
+   */
+  double GetRelativeHalfWidth (double level) const;
+
+  /**
+   * \param p probability (0 < p < 1)
+   * \param dof degrees of freedom
+   * \return the p quantile of the Student t distribution
+   */
+  static double GetStudentTQuantile (double p, uint32_t dof);
+
+private:
+  uint32_t m_count;
+  double m_mean;
+  double m_m2;  //!< Sum of squared differences from the mean
+  double m_min;
+  double m_max;
+};
+
+/**
+ * \brief Adaptive number of replications: runs are added until the confidence
+ * intervals of the chosen RunSummary values are narrow enough.
+ *
+ * Metrics are named "aap.<value>" or "aaf.<value>" (all packets and all flows
+ * averages, value names as in Summary, e.g. "aap.throughput", "aaf.e2eDelayAverage").
+ * IsConverged () is true when at least the minimum number of runs is added and
+ * the relative half-width of every metric is at most the target.
+ */
+class StatsReplicationControl
+{
+public:
+  StatsReplicationControl ();
+
+  /**
+   * \brief Set the stopping target
+   * \param relativeHalfWidth target half-width of the confidence interval relative to the mean, e.g. 0.05
+   * \param level confidence level, e.g. 0.95
+   */
+  void SetTarget (double relativeHalfWidth, double level = 0.95);
+  double GetTargetRelativeHalfWidth () const { return m_target; };
+  double GetConfidenceLevel () const { return m_level; };
+  /**
+   * \param minRuns the minimum number of runs before the intervals are checked (at least 2)
+   */
+  void SetMinRuns (uint32_t minRuns);
+
+  /**
+   * \param name metric name, e.g. "aap.throughput"
+   * \return false if there is no such metric
+   */
+  bool AddMetric (std::string name);
+  /**
+   * \param names comma separated metric names
+   * \return false if any of the metrics does not exist
+   */
+  bool ParseMetrics (std::string names);
+  uint32_t GetNMetrics () const { return m_names.size (); };
+  std::string GetMetricName (uint32_t metric) const { return m_names[metric]; };
+  const StatsRunningStat & GetMetricStat (uint32_t metric) const { return m_stats[metric]; };
+
+  /**
+   * \brief Add the chosen values of one run
+   * \param srs the run summary
+   * \return IsConverged () after the run is added
+   */
+  bool Add (const RunSummary &srs);
+  bool IsConverged () const;
+  uint32_t GetNRuns () const { return m_nRuns; };
+  void Clear ();
+
+  /**
+   * \brief Write one line per metric: name, runs, mean, half-width, relative half-width
+   * \param out the output stream
+   */
+  void WriteCsv (std::ostream &out) const;
+
+private:
+  std::vector<std::string> m_names;
+  std::vector<bool> m_allFlows;       //!< aaf (true) or aap (false) value of the metric
+  std::vector<uint32_t> m_indexes;    //!< Summary value index of the metric
+  std::vector<StatsRunningStat> m_stats;
+  double m_target;
+  double m_level;
+  uint32_t m_minRuns;
+  uint32_t m_nRuns;
+};
+
+/**
+ * \brief Cross-run statistics of all RunSummary values.
+ *
+ * Every value of the all packets (aap) and all flows (aaf) Summary is kept
+ * for every added run, so the minimum, maximum, mean, median, standard
+ * deviation and confidence interval over runs are computed directly instead
+ * of left to spreadsheet formulas. The E2E delay histograms of the runs are
+ * merged, giving exact delay percentiles of all packets of all runs.
+ *
+ * With external RNG run control every run is a separate program execution:
+ * the aggregator is then rebuilt from the stored summaries of all finished
+ * runs (see StatsSummaryStore).
+ */
+class StatsRunAggregator
+{
+public:
+  StatsRunAggregator ();
+
+  /**
+   * \brief Add one run
+   * \param rngRun RNG run number of the run
+   * \param srs the run summary
+   */
+  void Add (uint64_t rngRun, const RunSummary &srs);
+  void Clear ();
+
+  uint32_t GetNRuns () const { return m_rngRuns.size (); };
+  const std::vector<uint64_t> & GetRngRuns () const { return m_rngRuns; };
+  /**
+   * \param allFlows all flows (aaf) instead of all packets (aap) average
+   * \param value Summary value index (Summary::GetValueIndex ())
+   * \return statistics of the value over all runs
+   */
+  const StatsRunningStat & GetStat (bool allFlows, uint32_t value) const;
+  /**
+   * \param allFlows all flows (aaf) instead of all packets (aap) average
+   * \param value Summary value index (Summary::GetValueIndex ())
+   * \return median of the value over all runs, 0 without runs
+   */
+  double GetMedian (bool allFlows, uint32_t value) const;
+  /// \return merged E2E delay histogram of all packets of all runs
+  const StatsHist & GetDelayHist () const { return m_delayHist; };
+
+private:
+  uint32_t GetSeries (bool allFlows, uint32_t value) const;
+
+  std::vector<uint64_t> m_rngRuns;
+  std::vector<std::vector<double> > m_values; //!< Values of every run, by series (aap values, then aaf values)
+  std::vector<StatsRunningStat> m_stats;      //!< Statistics of every series
+  StatsHist m_delayHist;
+};
+
+} // namespace ns3
+
+#endif /* STATS_REPLICATION_H */
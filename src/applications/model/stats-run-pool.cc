@@ -0,0 +1,342 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/stats-run-pool.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsRunPool");
+
+namespace {
+
+/// Result message header, followed by the serialized RunSummary
+struct ResultHeader
+{
+  uint32_t job;
+  double seconds;  //!< wall-clock time of the job in the worker
+  uint64_t length; //!< length of the serialized RunSummary
+};
+
+// Read or write exactly len bytes, false on end of file or error
+bool
+ReadAll (int fd, void *data, size_t len)
+{
+  char *p = (char *)data;
+  while (len > 0)
+    {
+      ssize_t n = read (fd, p, len);
+      if (n < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (n <= 0)
+        {
+          return false;
+        }
+      p += n;
+      len -= n;
+    }
+  return true;
+}
+
+bool
+WriteAll (int fd, const void *data, size_t len)
+{
+  const char *p = (const char *)data;
+  while (len > 0)
+    {
+      ssize_t n = write (fd, p, len);
+      if (n < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (n <= 0)
+        {
+          return false;
+        }
+      p += n;
+      len -= n;
+    }
+  return true;
+}
+
+/// Parent side of one worker
+struct Worker
+{
+  pid_t pid;
+  int jobFd;    //!< parent -> worker, job numbers
+  int resultFd; //!< worker -> parent, results
+  uint32_t job; //!< job in progress
+  bool busy;
+};
+
+} // anonymous namespace
+
+StatsRunPool::StatsRunPool (uint32_t nWorkers)
+  : m_nWorkers (nWorkers),
+    m_stopped (false),
+    m_wallClockTime (0),
+    m_jobsTime (0)
+{
+  NS_LOG_FUNCTION (this << nWorkers);
+}
+
+uint32_t
+StatsRunPool::GetNCores ()
+{
+  long n = sysconf (_SC_NPROCESSORS_ONLN);
+  return n > 0 ? n : 1;
+}
+
+bool
+StatsRunPool::IsCompleted (uint32_t job) const
+{
+  return job < m_completed.size () && m_completed[job];
+}
+
+const RunSummary &
+StatsRunPool::GetResult (uint32_t job) const
+{
+  NS_ASSERT_MSG (IsCompleted (job), "Job " << job << " is not completed.");
+  return m_results[job];
+}
+
+double
+StatsRunPool::GetSpeedup () const
+{
+  return m_wallClockTime > 0 ? m_jobsTime / m_wallClockTime : 0.0;
+}
+
+void
+StatsRunPool::WorkerLoop (int jobFd, int resultFd, JobCallback job)
+{
+  uint32_t jobNumber;
+  while (ReadAll (jobFd, &jobNumber, sizeof (jobNumber)))
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      RunSummary srs = job (jobNumber);
+      std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now ();
+
+      std::ostringstream payload;
+      srs.Serialize (payload);
+      std::string data = payload.str ();
+      ResultHeader header;
+      header.job = jobNumber;
+      header.seconds = std::chrono::duration<double> (stop - start).count ();
+      header.length = data.size ();
+      std::cout.flush ();
+      if (!WriteAll (resultFd, &header, sizeof (header)) || !WriteAll (resultFd, data.data (), data.size ()))
+        {
+          break;
+        }
+    }
+}
+
+uint32_t
+StatsRunPool::Run (uint32_t nJobs, JobCallback job)
+{
+  NS_LOG_FUNCTION (this << nJobs << m_nWorkers);
+  m_results.assign (nJobs, RunSummary ());
+  m_completed.assign (nJobs, false);
+  m_jobsTime = 0;
+  m_stopped = false;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+  if (m_nWorkers == 0)
+    {
+      uint32_t nCompleted = 0;
+      for (uint32_t j = 0; j < nJobs && !m_stopped; ++j)
+        {
+          std::chrono::steady_clock::time_point jobStart = std::chrono::steady_clock::now ();
+          m_results[j] = job (j);
+          m_completed[j] = true;
+          nCompleted++;
+          m_jobsTime += std::chrono::duration<double> (std::chrono::steady_clock::now () - jobStart).count ();
+          if (!m_resultCallback.IsNull ())
+            {
+              m_resultCallback (j, m_results[j]);
+            }
+        }
+      m_wallClockTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+      return nCompleted;
+    }
+
+  // a worker that dies must not kill the parent when its job pipe is written
+  void (*oldHandler) (int) = std::signal (SIGPIPE, SIG_IGN);
+  std::cout.flush (); // do not duplicate buffered output in the workers
+
+  uint32_t nWorkers = m_nWorkers < nJobs ? m_nWorkers : nJobs;
+  std::vector<Worker> workers;
+  for (uint32_t w = 0; w < nWorkers; ++w)
+    {
+      int jobPipe[2], resultPipe[2];
+      NS_ABORT_MSG_IF (pipe (jobPipe) != 0 || pipe (resultPipe) != 0, "Cannot create pipes for the worker processes.");
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Cannot fork worker process.");
+      if (pid == 0)
+        {
+          // worker: keep only its own pipe ends
+          for (uint32_t i = 0; i < workers.size (); ++i)
+            {
+              close (workers[i].jobFd);
+              close (workers[i].resultFd);
+            }
+          close (jobPipe[1]);
+          close (resultPipe[0]);
+          WorkerLoop (jobPipe[0], resultPipe[1], job);
+          std::cout.flush ();
+          std::fflush (0);
+          _exit (0); // no static destructors of the parent's copy
+        }
+      close (jobPipe[0]);
+      close (resultPipe[1]);
+      Worker worker;
+      worker.pid = pid;
+      worker.jobFd = jobPipe[1];
+      worker.resultFd = resultPipe[0];
+      worker.job = 0;
+      worker.busy = false;
+      workers.push_back (worker);
+    }
+
+  // work queue: next job goes to the first idle worker
+  uint32_t nextJob = 0;
+  uint32_t nCompleted = 0;
+  uint32_t nBusy = 0;
+  for (uint32_t w = 0; w < workers.size (); ++w)
+    {
+      if (nextJob < nJobs && WriteAll (workers[w].jobFd, &nextJob, sizeof (nextJob)))
+        {
+          workers[w].job = nextJob++;
+          workers[w].busy = true;
+          nBusy++;
+        }
+    }
+  while (nBusy > 0)
+    {
+      std::vector<struct pollfd> fds;
+      std::vector<uint32_t> fdWorker;
+      for (uint32_t w = 0; w < workers.size (); ++w)
+        {
+          if (workers[w].busy)
+            {
+              struct pollfd fd;
+              fd.fd = workers[w].resultFd;
+              fd.events = POLLIN;
+              fd.revents = 0;
+              fds.push_back (fd);
+              fdWorker.push_back (w);
+            }
+        }
+      if (poll (&fds[0], fds.size (), -1) < 0)
+        {
+          NS_ABORT_MSG_IF (errno != EINTR, "Waiting for the worker processes failed.");
+          continue;
+        }
+      for (uint32_t i = 0; i < fds.size (); ++i)
+        {
+          if (fds[i].revents == 0)
+            {
+              continue;
+            }
+          Worker &worker = workers[fdWorker[i]];
+          worker.busy = false;
+          nBusy--;
+          ResultHeader header;
+          std::string data;
+          bool ok = ReadAll (worker.resultFd, &header, sizeof (header)) && header.job == worker.job;
+          if (ok)
+            {
+              data.resize (header.length);
+              ok = header.length == 0 || ReadAll (worker.resultFd, &data[0], header.length);
+            }
+          if (ok)
+            {
+              std::istringstream payload (data);
+              ok = m_results[header.job].Deserialize (payload);
+            }
+          if (!ok)
+            {
+              NS_LOG_WARN ("Worker " << worker.pid << " failed in job " << worker.job);
+              close (worker.jobFd);
+              close (worker.resultFd);
+              worker.jobFd = worker.resultFd = -1;
+              continue;
+            }
+          m_completed[header.job] = true;
+          m_jobsTime += header.seconds;
+          nCompleted++;
+          NS_LOG_INFO ("Job " << header.job << " completed by worker " << worker.pid << " in " << header.seconds << " s");
+          if (!m_resultCallback.IsNull ())
+            {
+              m_resultCallback (header.job, m_results[header.job]);
+            }
+          if (!m_stopped && nextJob < nJobs && WriteAll (worker.jobFd, &nextJob, sizeof (nextJob)))
+            {
+              worker.job = nextJob++;
+              worker.busy = true;
+              nBusy++;
+            }
+        }
+      if (nBusy == 0 && nextJob < nJobs && !m_stopped)
+        {
+          NS_LOG_WARN ("All workers failed, " << nJobs - nextJob << " jobs not started");
+        }
+    }
+
+  // closing the job pipe stops the worker
+  for (uint32_t w = 0; w < workers.size (); ++w)
+    {
+      if (workers[w].jobFd >= 0)
+        {
+          close (workers[w].jobFd);
+          close (workers[w].resultFd);
+        }
+      int status;
+      waitpid (workers[w].pid, &status, 0);
+    }
+  std::signal (SIGPIPE, oldHandler);
+
+  m_wallClockTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  if (m_stopped)
+    {
+      NS_LOG_INFO ("Stopped, " << nJobs - nextJob << " jobs not started");
+    }
+  NS_LOG_INFO ("Jobs completed: " << nCompleted << " of " << nJobs << ", speedup " << GetSpeedup ());
+  return nCompleted;
+}
+
+} // namespace ns3
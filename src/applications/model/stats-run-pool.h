@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef STATS_RUN_POOL_H
+#define STATS_RUN_POOL_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/callback.h"
+#include "ns3/stats-data.h"
+
+namespace ns3 {
+
+/**
+ * \brief Executes independent simulation runs (jobs) in forked worker processes.
+ *
+ * Run () forks the workers and hands out job numbers 0 ... nJobs - 1 from
+ * a work queue: every worker gets the next job as soon as it returns the
+ * RunSummary of the previous one, so long and short runs are balanced.
+ * A worker calls the job callback (which builds, runs and destroys one
+ * simulation), serializes the RunSummary and sends it to the parent through a pipe.
+ * Results are stored by job number, so they can be written in a deterministic
+ * order regardless of which worker finished first.
+ *
+ * Every worker is a copy of the parent at the time of Run (), so the parent
+ * should not create simulation objects before calling it. Simulator::Destroy ()
+ * at the end of every job is enough to reuse a worker for the next job.
+ * If a worker dies, its job is marked as not completed and the remaining
+ * jobs are given to the other workers.
+ */
+class StatsRunPool
+{
+public:
+  /// Job callback: job number -> summary of the run
+  typedef Callback<RunSummary, uint32_t> JobCallback;
+  /// Result callback: job number, summary of the run
+  typedef Callback<void, uint32_t, const RunSummary &> ResultCallback;
+
+  /**
+   * \brief Constructor
+   * \param nWorkers number of worker processes, 0 to execute the jobs in the calling process
+   */
+  StatsRunPool (uint32_t nWorkers = 0);
+
+  void SetNWorkers (uint32_t nWorkers) { m_nWorkers = nWorkers; };
+  uint32_t GetNWorkers () const { return m_nWorkers; };
+  /**
+   * \brief Set the callback called in the calling process as soon as a job
+   * returns its summary (in completion order, not in job order)
+   * \param result the result callback
+   */
+  void SetResultCallback (ResultCallback result) { m_resultCallback = result; };
+
+  /**
+   * \brief Execute all jobs and wait for the results
+   * \param nJobs number of jobs
+   * \param job the job callback, called in the worker processes
+   * \return number of completed jobs
+   */
+  uint32_t Run (uint32_t nJobs, JobCallback job);
+  /**
+   * \brief Do not start any more jobs in the current Run (), jobs in progress
+   * are finished. Meant to be called from the result callback.
+   */
+  void Stop () { m_stopped = true; };
+  bool IsStopped () const { return m_stopped; };
+
+  uint32_t GetNJobs () const { return m_results.size (); };
+  bool IsCompleted (uint32_t job) const;
+  /**
+   * \param job the job number
+   * \return summary returned by the job (valid if IsCompleted (job))
+   */
+  const RunSummary & GetResult (uint32_t job) const;
+
+  /// \return wall-clock time of the last Run () [s]
+  double GetWallClockTime () const { return m_wallClockTime; };
+  /// \return sum of the wall-clock times of all completed jobs, as measured by the workers [s]
+  double GetJobsTime () const { return m_jobsTime; };
+  /// \return GetJobsTime () / GetWallClockTime (), the speedup over running the same jobs one by one
+  double GetSpeedup () const;
+
+  /// \return number of online processor cores
+  static uint32_t GetNCores ();
+
+private:
+  /// Worker side of Run (): execute jobs until the parent closes the job pipe
+  static void WorkerLoop (int jobFd, int resultFd, JobCallback job);
+
+  uint32_t m_nWorkers;
+  ResultCallback m_resultCallback;
+  bool m_stopped;                    //!< Stop () called in the current Run ()
+  std::vector<RunSummary> m_results; //!< Summary of every job, by job number
+  std::vector<bool> m_completed;     //!< Job returned its summary
+  double m_wallClockTime;
+  double m_jobsTime;
+};
+
+} // namespace ns3
+
+#endif /* STATS_RUN_POOL_H */
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/stats-summary-store.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsSummaryStore");
+
+namespace {
+
+const uint32_t SHARD_MAGIC = 0x53525332; // "SRS2"
+const uint32_t MAX_SETTINGS_LENGTH = 1 << 20;
+
+} // anonymous namespace
+
+StatsSummaryStore::StatsSummaryStore (std::string prefix, std::string settings)
+  : m_prefix (prefix),
+    m_settings (settings),
+    m_lockFd (-1)
+{
+  NS_LOG_FUNCTION (this << prefix);
+}
+
+StatsSummaryStore::~StatsSummaryStore ()
+{
+  Unlock ();
+}
+
+std::string
+StatsSummaryStore::GetShardFileName (uint64_t rngRun) const
+{
+  std::ostringstream name;
+  name << m_prefix << "-run" << rngRun << ".bin";
+  return name.str ();
+}
+
+bool
+StatsSummaryStore::Put (uint64_t rngRun, const RunSummary &srs) const
+{
+  NS_LOG_FUNCTION (this << rngRun);
+  std::ostringstream shard;
+  shard.write ((const char *)&SHARD_MAGIC, sizeof (SHARD_MAGIC));
+  shard.write ((const char *)&rngRun, sizeof (rngRun));
+  uint32_t settingsLength = m_settings.size ();
+  shard.write ((const char *)&settingsLength, sizeof (settingsLength));
+  shard.write (m_settings.data (), settingsLength);
+  srs.Serialize (shard);
+  return WriteFileAtomic (GetShardFileName (rngRun), shard.str ());
+}
+
+bool
+StatsSummaryStore::Get (uint64_t rngRun, RunSummary &srs) const
+{
+  std::ifstream in (GetShardFileName (rngRun).c_str (), std::ifstream::binary);
+  uint32_t magic = 0;
+  uint64_t run = 0;
+  in.read ((char *)&magic, sizeof (magic));
+  in.read ((char *)&run, sizeof (run));
+  uint32_t settingsLength = 0;
+  in.read ((char *)&settingsLength, sizeof (settingsLength));
+  if (!in || magic != SHARD_MAGIC || run != rngRun || settingsLength > MAX_SETTINGS_LENGTH)
+    {
+      return false;
+    }
+  std::string settings (settingsLength, ' ');
+  in.read (&settings[0], settingsLength);
+  if (!in || settings != m_settings)
+    {
+      NS_LOG_WARN ("Shard of rng run " << rngRun << " was written with other settings, skipped");
+      return false;
+    }
+  RunSummary shardSrs;
+  if (!shardSrs.Deserialize (in))
+    {
+      NS_LOG_WARN ("Shard of rng run " << rngRun << " is not valid");
+      return false;
+    }
+  srs = shardSrs;
+  return true;
+}
+
+void
+StatsSummaryStore::Lock ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_lockFd >= 0)
+    {
+      return;
+    }
+  std::string lockFileName = m_prefix + ".lock";
+  m_lockFd = open (lockFileName.c_str (), O_RDWR | O_CREAT, 0644);
+  NS_ABORT_MSG_IF (m_lockFd < 0, "Cannot open lock file " << lockFileName);
+  while (flock (m_lockFd, LOCK_EX) != 0)
+    {
+      NS_ABORT_MSG_IF (errno != EINTR, "Cannot lock " << lockFileName);
+    }
+}
+
+void
+StatsSummaryStore::Unlock ()
+{
+  if (m_lockFd >= 0)
+    {
+      flock (m_lockFd, LOCK_UN);
+      close (m_lockFd);
+      m_lockFd = -1;
+    }
+}
+
+bool
+StatsSummaryStore::WriteFileAtomic (std::string fileName, const std::string &content)
+{
+  std::ostringstream tempName;
+  tempName << fileName << ".tmp" << getpid ();
+  int fd = open (tempName.str ().c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Cannot create " << tempName.str ());
+      return false;
+    }
+  const char *p = content.data ();
+  size_t len = content.size ();
+  while (len > 0)
+    {
+      ssize_t n = write (fd, p, len);
+      if (n < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (n <= 0)
+        {
+          break;
+        }
+      p += n;
+      len -= n;
+    }
+  // the data must be on disk before the rename makes it visible
+  bool ok = len == 0 && fsync (fd) == 0;
+  ok = close (fd) == 0 && ok;
+  if (!ok || std::rename (tempName.str ().c_str (), fileName.c_str ()) != 0)
+    {
+      NS_LOG_WARN ("Cannot write " << fileName);
+      std::remove (tempName.str ().c_str ());
+      return false;
+    }
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef STATS_SUMMARY_STORE_H
+#define STATS_SUMMARY_STORE_H
+
+#include <string>
+#include <stdint.h>
+
+#include "ns3/stats-data.h"
+
+namespace ns3 {
+
+/**
+ * \brief Run summaries of program executions that run concurrently
+ * (external RNG run control).
+ *
+ * Every run stores its RunSummary in its own shard file,
+ * "<prefix>-run<rng run>.bin", which is written to a temporary file and
+ * renamed, so a shard is either complete or missing (a crashed run leaves
+ * no partial record) and runs never write to the same file. Files built
+ * from all shards (e.g. the summary CSV) are rewritten under an exclusive
+ * lock of "<prefix>.lock" and also replaced atomically with WriteFileAtomic ().
+ *
+ * A shard of a run is overwritten when the run is repeated. Every shard also
+ * holds the settings of its series (e.g. the program command line without the
+ * rng run), and Get () rejects the shards of a series with other settings
+ * left behind under the same prefix.
+ */
+class StatsSummaryStore
+{
+public:
+  /**
+   * \param prefix file name prefix of the shards and of the lock file
+   * \param settings settings of the series, stored in every shard and checked by Get ()
+   */
+  StatsSummaryStore (std::string prefix, std::string settings = "");
+  ~StatsSummaryStore ();
+
+  /**
+   * \brief Store the summary of one run (atomically replaces an earlier shard of the run)
+   * \param rngRun the RNG run
+   * \param srs the run summary
+   * \return false if the shard could not be written
+   */
+  bool Put (uint64_t rngRun, const RunSummary &srs) const;
+  /**
+   * \param rngRun the RNG run
+   * \param srs the run summary, set if the shard exists
+   * \return false if there is no (valid) shard of the run, or it was written with other settings
+   */
+  bool Get (uint64_t rngRun, RunSummary &srs) const;
+  std::string GetShardFileName (uint64_t rngRun) const;
+
+  /// Wait for the exclusive lock of the store (between processes)
+  void Lock ();
+  void Unlock ();
+
+  /**
+   * \brief Replace a file with new content: a reader sees either the old or the new file
+   * \param fileName the file name
+   * \param content the new content
+   * \return false if the file could not be written
+   */
+  static bool WriteFileAtomic (std::string fileName, const std::string &content);
+
+private:
+  std::string m_prefix;
+  std::string m_settings;
+  int m_lockFd; //!< Open lock file while locked, -1 otherwise
+};
+
+} // namespace ns3
+
+#endif /* STATS_SUMMARY_STORE_H */
@@ -0,0 +1,385 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/stats-sweep.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsSweep");
+
+namespace {
+
+std::vector<std::string>
+Split (std::string text, char separator)
+{
+  std::vector<std::string> items;
+  std::istringstream in (text);
+  std::string item;
+  while (std::getline (in, item, separator))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+} // anonymous namespace
+
+StatsSweep::StatsSweep ()
+  : m_startRngRun (1),
+    m_stopRngRun (1),
+    m_nSkipped (0),
+    m_nFailed (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+StatsSweep::AddParameter (std::string name, std::string values)
+{
+  NS_LOG_FUNCTION (this << name << values);
+  std::vector<std::string> list = Split (values, ',');
+  NS_ASSERT_MSG (!name.empty () && !list.empty (), "Sweep parameter needs a name and at least one value.");
+  m_names.push_back (name);
+  m_values.push_back (list);
+}
+
+bool
+StatsSweep::ParseGrid (std::string grid)
+{
+  NS_LOG_FUNCTION (this << grid);
+  std::vector<std::string> parameters = Split (grid, ';');
+  for (uint32_t i = 0; i < parameters.size (); ++i)
+    {
+      std::string::size_type eq = parameters[i].find ('=');
+      if (eq == std::string::npos || eq == 0 || Split (parameters[i].substr (eq + 1), ',').empty ())
+        {
+          NS_LOG_WARN ("Not a valid sweep parameter: " << parameters[i]);
+          return false;
+        }
+      AddParameter (parameters[i].substr (0, eq), parameters[i].substr (eq + 1));
+    }
+  return !parameters.empty ();
+}
+
+void
+StatsSweep::SetRngRuns (uint64_t startRun, uint64_t stopRun)
+{
+  NS_ASSERT_MSG (startRun <= stopRun, "First run number must be less or equal to last.");
+  m_startRngRun = startRun;
+  m_stopRngRun = stopRun;
+}
+
+void
+StatsSweep::SetSettings (const std::vector<std::string> &arguments)
+{
+  NS_LOG_FUNCTION (this);
+  std::map<std::string, std::string> settings; // name -> the whole argument, sorted by name
+  for (uint32_t i = 0; i < arguments.size (); ++i)
+    {
+      std::string name = arguments[i].substr (0, arguments[i].find ('='));
+      if (name.compare (0, 2, "--") == 0
+          && std::find (m_names.begin (), m_names.end (), name.substr (2)) != m_names.end ())
+        {
+          continue; // swept, the value of the grid point is used
+        }
+      settings[name] = arguments[i];
+    }
+  m_settings.clear ();
+  for (std::map<std::string, std::string>::const_iterator it = settings.begin (); it != settings.end (); ++it)
+    {
+      m_settings += (m_settings.empty () ? "" : " ") + it->second;
+    }
+}
+
+uint32_t
+StatsSweep::GetNPoints () const
+{
+  uint32_t n = 1;
+  for (uint32_t p = 0; p < m_values.size (); ++p)
+    {
+      n *= m_values[p].size ();
+    }
+  return n;
+}
+
+std::string
+StatsSweep::GetValue (uint32_t point, uint32_t parameter) const
+{
+  // mixed radix number, the last parameter is the lowest digit
+  for (uint32_t p = m_values.size () - 1; p > parameter; --p)
+    {
+      point /= m_values[p].size ();
+    }
+  return m_values[parameter][point % m_values[parameter].size ()];
+}
+
+std::vector<std::string>
+StatsSweep::GetArguments (uint32_t point) const
+{
+  std::vector<std::string> arguments;
+  for (uint32_t p = 0; p < m_names.size (); ++p)
+    {
+      arguments.push_back ("--" + m_names[p] + "=" + GetValue (point, p));
+    }
+  return arguments;
+}
+
+std::string
+StatsSweep::GetKey (uint32_t point) const
+{
+  std::string key;
+  for (uint32_t p = 0; p < m_names.size (); ++p)
+    {
+      key += (p > 0 ? "," : "") + GetValue (point, p);
+    }
+  return key;
+}
+
+std::string
+StatsSweep::GetTableHeader () const
+{
+  std::string header;
+  for (uint32_t p = 0; p < m_names.size (); ++p)
+    {
+      header += m_names[p] + ",";
+    }
+  return header + "Rng Run,Number of Flows,"
+         + "Throughput AAF [bps],Throughput AAP [bps],Tx Packets AAF,Tx Packets AAP,Rx Packets AAF,Rx Packets AAP,"
+         + "Lost Packets AAF,Lost Packets AAP,Lost Ratio AAF [%],Lost Ratio AAP [%],"
+         + "E2E Delay Min AAF [ms],E2E Delay Min AAP [ms],E2E Delay Max AAF [ms],E2E Delay Max AAP [ms],"
+         + "E2E Delay Average AAF [ms],E2E Delay Average AAP [ms],E2E Delay Median Estimate AAF [ms],E2E Delay Median Estimate AAP [ms],"
+         + "E2E Delay Jitter AAF [ms],E2E Delay Jitter AAP [ms],E2E Delay 90th Percentile AAF [ms],E2E Delay 90th Percentile AAP [ms],"
+         + "E2E Delay 95th Percentile AAF [ms],E2E Delay 95th Percentile AAP [ms],E2E Delay 99th Percentile AAF [ms],E2E Delay 99th Percentile AAP [ms],"
+         + "E2E Delay 99.9th Percentile AAF [ms],E2E Delay 99.9th Percentile AAP [ms],PHY Tx Packets,PHY over APP Traffic Ratio [%],"
+         + "Peak RSS [MB],End RSS [MB],Wall-clock Time [s],Simulated/Wall-clock Time,Simulator Events,Simulator Events per Second,"
+         + "Stats Callbacks,Time in Stats Callbacks [s]";
+}
+
+std::string
+StatsSweep::GetSettingsLine () const
+{
+  // one quoted CSV field, quotes doubled
+  std::string quoted;
+  for (std::string::size_type i = 0; i < m_settings.size (); ++i)
+    {
+      quoted += m_settings[i] == '"' ? "\"\"" : std::string (1, m_settings[i]);
+    }
+  return "Sweep Settings,\"" + quoted + "\"";
+}
+
+bool
+StatsSweep::LoadTable (std::string tableFileName)
+{
+  NS_LOG_FUNCTION (this << tableFileName);
+  m_completed.clear ();
+  std::ifstream in (tableFileName.c_str ());
+  std::string line;
+  if (!std::getline (in, line))
+    {
+      return true; // new table
+    }
+  if (line != GetSettingsLine ())
+    {
+      NS_LOG_WARN ("Settings of " << tableFileName << ": " << line << ", settings of this sweep: " << GetSettingsLine ());
+      return false;
+    }
+  if (!std::getline (in, line) || line != GetTableHeader ())
+    {
+      return false;
+    }
+  uint32_t nColumns = Split (GetTableHeader (), ',').size ();
+  while (std::getline (in, line))
+    {
+      std::vector<std::string> fields = Split (line, ',');
+      // unfinished row of an interrupted sweep: the last line without '\n' (getline
+      // reached the end of the file) can have all columns with its last value cut off
+      if (in.eof () || fields.size () != nColumns)
+        {
+          continue;
+        }
+      std::string key;
+      for (uint32_t p = 0; p <= m_names.size (); ++p)
+        {
+          key += (p > 0 ? "," : "") + fields[p];
+        }
+      m_completed.insert (key);
+    }
+  return true;
+}
+
+uint32_t
+StatsSweep::Run (std::string tableFileName, uint32_t nWorkers, JobCallback job)
+{
+  NS_LOG_FUNCTION (this << tableFileName << nWorkers);
+  NS_ABORT_MSG_UNLESS (LoadTable (tableFileName), "Results table " << tableFileName << " was written for other sweep parameters or settings"
+                       << " (first line of the table), use another file name prefix.");
+
+  m_jobs.clear ();
+  m_nSkipped = 0;
+  for (uint32_t point = 0; point < GetNPoints (); ++point)
+    {
+      for (uint64_t run = m_startRngRun; run <= m_stopRngRun; ++run)
+        {
+          if (m_completed.count (GetKey (point) + "," + std::to_string (run)))
+            {
+              m_nSkipped++;
+              continue;
+            }
+          Job j;
+          j.point = point;
+          j.rngRun = run;
+          m_jobs.push_back (j);
+        }
+    }
+  NS_LOG_INFO ("Sweep points: " << GetNPoints () << ", jobs: " << m_jobs.size () << ", already in the table: " << m_nSkipped);
+
+  // append to an existing table; an unfinished last row is dropped first (the sorted
+  // copy has complete rows only), otherwise it would become a complete looking line
+  std::ifstream in (tableFileName.c_str (), std::ifstream::binary);
+  bool exists = in && in.peek () != std::ifstream::traits_type::eof ();
+  bool unfinished = exists && in.seekg (-1, std::ifstream::end) && in.get () != '\n';
+  in.close ();
+  if (unfinished)
+    {
+      SortTable (tableFileName);
+    }
+  if (exists)
+    {
+      m_table.open (tableFileName.c_str (), std::ofstream::out | std::ofstream::app);
+    }
+  else
+    {
+      m_table.open (tableFileName.c_str (), std::ofstream::out | std::ofstream::trunc);
+      m_table << GetSettingsLine () << std::endl;
+      m_table << GetTableHeader () << std::endl;
+    }
+
+  m_job = job;
+  m_pool.SetNWorkers (nWorkers);
+  m_pool.SetResultCallback (MakeCallback (&StatsSweep::WriteRow, this));
+  uint32_t nCompleted = m_pool.Run (m_jobs.size (), MakeCallback (&StatsSweep::DoJob, this));
+  m_nFailed = m_jobs.size () - nCompleted;
+  m_table.close ();
+  SortTable (tableFileName);
+  return nCompleted;
+}
+
+void
+StatsSweep::SortTable (std::string tableFileName) const
+{
+  NS_LOG_FUNCTION (this << tableFileName);
+  // rows are appended in completion order, the final table is in grid order (rows of
+  // points that are not in the current grid last), then by RNG run; unfinished rows are dropped
+  std::map<std::string, uint32_t> pointIndex;
+  for (uint32_t point = 0; point < GetNPoints (); ++point)
+    {
+      pointIndex[GetKey (point)] = point;
+    }
+  uint32_t nColumns = Split (GetTableHeader (), ',').size ();
+  std::vector<std::pair<std::pair<uint64_t, uint64_t>, std::string> > rows;
+  std::ifstream in (tableFileName.c_str ());
+  std::string line;
+  std::getline (in, line); // settings
+  std::getline (in, line); // header
+  while (std::getline (in, line))
+    {
+      std::vector<std::string> fields = Split (line, ',');
+      if (in.eof () || fields.size () != nColumns)
+        {
+          continue; // unfinished row (see LoadTable)
+        }
+      std::string key;
+      for (uint32_t p = 0; p < m_names.size (); ++p)
+        {
+          key += (p > 0 ? "," : "") + fields[p];
+        }
+      std::map<std::string, uint32_t>::const_iterator it = pointIndex.find (key);
+      uint64_t order = it != pointIndex.end () ? it->second : GetNPoints () + rows.size ();
+      rows.push_back (std::make_pair (std::make_pair (order, std::stoull (fields[m_names.size ()])), line));
+    }
+  in.close ();
+  std::stable_sort (rows.begin (), rows.end ());
+
+  // the table is replaced only when the sorted copy is complete
+  std::string tmpFileName = tableFileName + ".tmp";
+  std::ofstream out (tmpFileName.c_str (), std::ofstream::out | std::ofstream::trunc);
+  out << GetSettingsLine () << std::endl;
+  out << GetTableHeader () << std::endl;
+  for (uint32_t i = 0; i < rows.size (); ++i)
+    {
+      out << rows[i].second << "\n";
+    }
+  out.close ();
+  if (out && std::rename (tmpFileName.c_str (), tableFileName.c_str ()) != 0)
+    {
+      NS_LOG_WARN ("Cannot replace " << tableFileName << " with the sorted table " << tmpFileName);
+    }
+}
+
+RunSummary
+StatsSweep::DoJob (uint32_t job)
+{
+  return m_job (m_jobs[job].point, m_jobs[job].rngRun);
+}
+
+void
+StatsSweep::WriteRow (uint32_t job, const RunSummary &srs)
+{
+  // the whole row is written and flushed at once, so an interrupted sweep leaves at most one unfinished row
+  std::ostringstream row;
+  row << GetKey (m_jobs[job].point) << "," << m_jobs[job].rngRun << "," << srs.numberOfFlows << ","
+      << srs.aaf.throughput << "," << srs.aap.throughput << ","
+      << srs.aaf.txPackets << "," << srs.aap.txPackets << ","
+      << srs.aaf.rxPackets << "," << srs.aap.rxPackets << ","
+      << srs.aaf.lostPackets << "," << srs.aap.lostPackets << ","
+      << srs.aaf.lostRatio << "," << srs.aap.lostRatio << ","
+      << srs.aaf.e2eDelayMin * 1000.0 << "," << srs.aap.e2eDelayMin * 1000.0 << ","
+      << srs.aaf.e2eDelayMax * 1000.0 << "," << srs.aap.e2eDelayMax * 1000.0 << ","
+      << srs.aaf.e2eDelayAverage * 1000.0 << "," << srs.aap.e2eDelayAverage * 1000.0 << ","
+      << srs.aaf.e2eDelayMedianEstinate * 1000.0 << "," << srs.aap.e2eDelayMedianEstinate * 1000.0 << ","
+      << srs.aaf.e2eDelayJitter * 1000.0 << "," << srs.aap.e2eDelayJitter * 1000.0 << ","
+      << srs.aaf.e2eDelayP90 * 1000.0 << "," << srs.aap.e2eDelayP90 * 1000.0 << ","
+      << srs.aaf.e2eDelayP95 * 1000.0 << "," << srs.aap.e2eDelayP95 * 1000.0 << ","
+      << srs.aaf.e2eDelayP99 * 1000.0 << "," << srs.aap.e2eDelayP99 * 1000.0 << ","
+      << srs.aaf.e2eDelayP999 * 1000.0 << "," << srs.aap.e2eDelayP999 * 1000.0 << ","
+      << srs.aap.phyTxPkts << "," << srs.aap.usefullNetTraffic << ","
+      << srs.peakRss / 1048576.0 << "," << srs.endRss / 1048576.0 << ","
+      << srs.performance.wallClockTime << "," << srs.performance.GetSimulatedOverWallClock () << ","
+      << srs.performance.events << "," << srs.performance.GetEventsPerSecond () << ","
+      << srs.performance.statsCallbacks << "," << srs.performance.statsCallbackTime
+      << "\n";
+  m_table << row.str ();
+  m_table.flush ();
+}
+
+} // namespace ns3
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef STATS_SWEEP_H
+#define STATS_SWEEP_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <fstream>
+#include <stdint.h>
+
+#include "ns3/callback.h"
+#include "ns3/stats-data.h"
+#include "ns3/stats-run-pool.h"
+
+namespace ns3 {
+
+/**
+ * \brief Parameter sweep: every combination of the parameter values (grid point)
+ * is simulated for every RNG run in the run range.
+ *
+ * The grid is declared as a string of command line parameters and their values,
+ * e.g. "nNodes=60,120;nodeSpeed=1,5,10;dataRate=50kbps,100kbps" (2 x 3 x 2 = 12 points,
+ * the last parameter changes fastest). GetArguments () gives the command line
+ * arguments of a point, so a scenario that already parses its parameters from
+ * the command line needs no changes to be swept.
+ *
+ * Run () executes all (point, RNG run) jobs in worker processes (StatsRunPool)
+ * and appends one row per job to the results table as soon as the job is finished:
+ * the parameter values, the RNG run and the RunSummary values. When all jobs are
+ * finished the table is sorted by grid point and RNG run. Jobs whose rows are
+ * already in the table (e.g. from an interrupted sweep) are skipped, so a sweep
+ * is resumed by running the same command again.
+ *
+ * The first line of the table holds the settings that are the same for all
+ * grid points (SetSettings ()), the second line the column names. A table
+ * written with other settings or other swept parameters is not resumed:
+ * Run () aborts instead of reporting its rows as results of the new settings.
+ */
+class StatsSweep
+{
+public:
+  /// Job callback: grid point, RNG run -> summary of the run
+  typedef Callback<RunSummary, uint32_t, uint64_t> JobCallback;
+
+  StatsSweep ();
+
+  /**
+   * \brief Add one swept parameter
+   * \param name the command line parameter name (without "--")
+   * \param values comma separated values
+   */
+  void AddParameter (std::string name, std::string values);
+  /**
+   * \brief Add all parameters of a grid declaration
+   * \param grid "name=value,value;name=value,..."
+   * \return false if the declaration is not valid
+   */
+  bool ParseGrid (std::string grid);
+  void SetRngRuns (uint64_t startRun, uint64_t stopRun);
+  /**
+   * \brief Set the settings of all grid points, e.g. the program command line
+   * without the grid and the RNG run range.
+   *
+   * Arguments of swept parameters are ignored, a repeated parameter counts
+   * with its last value and the order of the arguments does not matter.
+   * Call after the grid is declared.
+   *
+   * \param arguments "--name=value" arguments
+   */
+  void SetSettings (const std::vector<std::string> &arguments);
+  /// \return the normalized settings, "--name=value" arguments sorted by name
+  std::string GetSettings () const { return m_settings; };
+
+  uint32_t GetNParameters () const { return m_names.size (); };
+  uint32_t GetNPoints () const;
+  /**
+   * \param point the grid point
+   * \return command line arguments of the point ("--name=value")
+   */
+  std::vector<std::string> GetArguments (uint32_t point) const;
+  /**
+   * \param point the grid point
+   * \return parameter values of the point, comma separated (the key of the point in the results table)
+   */
+  std::string GetKey (uint32_t point) const;
+
+  /**
+   * \brief Run all jobs that are not in the results table yet
+   * \param tableFileName the results table (CSV), created if it does not exist
+   * \param nWorkers number of worker processes
+   * \param job the job callback, called in the worker processes
+   * \return number of jobs completed in this call
+   */
+  uint32_t Run (std::string tableFileName, uint32_t nWorkers, JobCallback job);
+
+  uint32_t GetNSkipped () const { return m_nSkipped; };
+  uint32_t GetNFailed () const { return m_nFailed; };
+  const StatsRunPool & GetRunPool () const { return m_pool; };
+
+private:
+  /// One job: grid point and RNG run
+  struct Job
+  {
+    uint32_t point;
+    uint64_t rngRun;
+  };
+
+  std::string GetValue (uint32_t point, uint32_t parameter) const;
+  std::string GetTableHeader () const;
+  /// First line of the results table
+  std::string GetSettingsLine () const;
+  /// Read the rows of an existing results table, false if it was written for other parameters or settings
+  bool LoadTable (std::string tableFileName);
+  /// Rewrite the results table in grid point and RNG run order
+  void SortTable (std::string tableFileName) const;
+  RunSummary DoJob (uint32_t job);
+  void WriteRow (uint32_t job, const RunSummary &srs);
+
+  std::vector<std::string> m_names;                 //!< Parameter names
+  std::vector<std::vector<std::string> > m_values;  //!< Values of every parameter
+  uint64_t m_startRngRun;
+  uint64_t m_stopRngRun;
+  std::string m_settings;            //!< Normalized settings of all grid points
+  std::set<std::string> m_completed; //!< "<point key>,<rng run>" of the rows in the table
+  std::vector<Job> m_jobs;           //!< Jobs of the current Run ()
+  JobCallback m_job;
+  std::ofstream m_table;
+  StatsRunPool m_pool;
+  uint32_t m_nSkipped;
+  uint32_t m_nFailed;
+};
+
+} // namespace ns3
+
+#endif /* STATS_SWEEP_H */
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/stats-vector-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsVectorFile");
+
+namespace {
+const char g_binMagic[8] = {'S', 'T', 'A', 'T', 'S', 'V', 'E', 'C'};
+const uint32_t g_binVersion = 1;
+const uint32_t g_binByteOrderMark = 0x01020304;
+} // anonymous namespace
+
+StatsVectorFile::StatsVectorFile (uint32_t bufferSize)
+  : m_opened (false),
+    m_format (CSV),
+    m_bufferSize (bufferSize),
+    m_nRecords (0),
+    m_nBytesWritten (0),
+    m_async (false),
+    m_policy (BLOCK),
+    m_ringMask ((1 << 16) - 1),
+    m_head (0),
+    m_tail (0),
+    m_stop (false),
+    m_flushRequest (false),
+    m_nDropped (0),
+    m_nBlocked (0)
+{
+  NS_LOG_FUNCTION (this << bufferSize);
+}
+
+StatsVectorFile::~StatsVectorFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+StatsVectorFile::SetBufferSize (uint32_t bufferSize)
+{
+  NS_LOG_FUNCTION (this << bufferSize);
+  NS_ASSERT_MSG (!IsOpen (), "Buffer size can be changed only while the vector file is closed.");
+  m_bufferSize = bufferSize;
+}
+
+void
+StatsVectorFile::SetFormat (Format format)
+{
+  NS_LOG_FUNCTION (this << format);
+  NS_ASSERT_MSG (!IsOpen (), "Format can be changed only while the vector file is closed.");
+  m_format = format;
+}
+
+void
+StatsVectorFile::SetAsync (bool async, uint32_t ringSize, OverflowPolicy policy)
+{
+  NS_LOG_FUNCTION (this << async << ringSize << policy);
+  NS_ASSERT_MSG (!IsOpen (), "Asynchronous mode can be changed only while the vector file is closed.");
+  uint64_t size = 2;
+  while (size < ringSize)
+    {
+      size <<= 1;
+    }
+  m_async = async;
+  m_ringMask = size - 1;
+  m_policy = policy;
+}
+
+void
+StatsVectorFile::Open (std::string fileName, std::string valueName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  Close ();
+  m_file.open (fileName.c_str (), std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+  // the records would be lost without a diagnostic (and the writer thread must never get a closed file)
+  NS_ABORT_MSG_IF (!m_file.is_open (), "Cannot open vector file " << fileName);
+  m_opened = true;
+  m_buffer.reserve (m_bufferSize);
+  m_nRecords = 0;
+  m_nBytesWritten = 0;
+  m_nDropped = 0;
+  m_nBlocked = 0;
+  if (m_format == BINARY)
+    {
+      uint32_t recordSize = sizeof (Record);
+      uint32_t nameLength = valueName.size ();
+      Append (g_binMagic, sizeof (g_binMagic));
+      Append ((const char *)&g_binVersion, sizeof (g_binVersion));
+      Append ((const char *)&recordSize, sizeof (recordSize));
+      Append ((const char *)&g_binByteOrderMark, sizeof (g_binByteOrderMark));
+      Append ((const char *)&nameLength, sizeof (nameLength));
+      Append (valueName.c_str (), nameLength);
+    }
+  else
+    {
+      std::string header = "Flow Index, Time [us], Sequence Id, " + valueName + "\n";
+      Append (header.c_str (), header.size ());
+    }
+
+  if (m_async)
+    {
+      // From here on m_buffer and m_file belong to the writer thread until Close ()
+      m_ring.resize (m_ringMask + 1);
+      m_head.store (0);
+      m_tail.store (0);
+      m_stop.store (false);
+      m_flushRequest.store (false);
+      m_writer = std::thread (&StatsVectorFile::WriterThread, this);
+    }
+}
+
+bool
+StatsVectorFile::Write (Time rxTime, uint32_t flowIndex, uint32_t seqNo, Time delay)
+{
+  Record record;
+  record.rxTimeStep = rxTime.GetTimeStep ();
+  record.flowIndex = flowIndex;
+  record.seqNo = seqNo;
+  record.delayTimeStep = delay.GetTimeStep ();
+  if (!m_async)
+    {
+      AppendRecord (record);
+      m_nRecords++;
+      return true;
+    }
+
+  // single producer: only this thread changes m_head
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  if (head - m_tail.load (std::memory_order_acquire) > m_ringMask)
+    {
+      if (m_policy == DROP)
+        {
+          m_nDropped++;
+          return false;
+        }
+      m_nBlocked++;
+      while (head - m_tail.load (std::memory_order_acquire) > m_ringMask)
+        {
+          std::this_thread::yield ();
+        }
+    }
+  m_ring[head & m_ringMask] = record;
+  m_head.store (head + 1, std::memory_order_release);
+  m_nRecords++;
+  return true;
+}
+
+void
+StatsVectorFile::AppendRecord (const Record &record)
+{
+  if (m_format == BINARY)
+    {
+      Append ((const char *)&record, sizeof (record));
+    }
+  else
+    {
+      AppendCsvRecord (record.rxTimeStep, record.flowIndex, record.seqNo, record.delayTimeStep);
+    }
+}
+
+void
+StatsVectorFile::WriterThread ()
+{
+  // single consumer: only this thread changes m_tail
+  uint64_t tail = m_tail.load (std::memory_order_relaxed);
+  while (true)
+    {
+      uint64_t head = m_head.load (std::memory_order_acquire);
+      if (tail == head)
+        {
+          if (m_flushRequest.load (std::memory_order_acquire))
+            {
+              WriteBuffer ();
+              m_file.flush ();
+              m_flushRequest.store (false, std::memory_order_release);
+            }
+          // records written before m_stop was set are visible after it is seen
+          if (m_stop.load (std::memory_order_acquire)
+              && tail == m_head.load (std::memory_order_acquire))
+            {
+              break;
+            }
+          std::this_thread::sleep_for (std::chrono::microseconds (100));
+          continue;
+        }
+      while (tail != head)
+        {
+          AppendRecord (m_ring[tail & m_ringMask]);
+          ++tail;
+          m_tail.store (tail, std::memory_order_release);
+        }
+    }
+}
+
+void
+StatsVectorFile::AppendCsvRecord (int64_t rxTimeStep, uint32_t flowIndex, uint32_t seqNo, int64_t delayTimeStep)
+{
+  // "%g" gives the same text as the default std::ostream formatting used by the previous per-record writer
+  char record[96];
+  int len = std::snprintf (record, sizeof (record), "%u,%g,%u,", flowIndex, (double)rxTimeStep / 1000.0, seqNo);
+  Append (record, len);
+
+  // one empty column for every flow index below the current one
+  static const char commas[] = ",,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,";
+  uint32_t padding = flowIndex;
+  while (padding > 0)
+    {
+      uint32_t n = padding < sizeof (commas) - 1 ? padding : sizeof (commas) - 1;
+      Append (commas, n);
+      padding -= n;
+    }
+
+  len = std::snprintf (record, sizeof (record), "%g\n", (double)delayTimeStep / 1000.0);
+  Append (record, len);
+}
+
+void
+StatsVectorFile::Append (const char *data, uint32_t len)
+{
+  if (m_buffer.size () + len > m_bufferSize)
+    {
+      WriteBuffer ();
+    }
+  m_buffer.insert (m_buffer.end (), data, data + len);
+}
+
+void
+StatsVectorFile::Flush ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer.joinable ())
+    {
+      m_flushRequest.store (true, std::memory_order_release);
+      while (m_flushRequest.load (std::memory_order_acquire))
+        {
+          std::this_thread::yield ();
+        }
+      return;
+    }
+  WriteBuffer ();
+}
+
+void
+StatsVectorFile::WriteBuffer ()
+{
+  if (m_buffer.empty ())
+    {
+      return;
+    }
+  NS_ASSERT_MSG (IsOpen (), "Vector file is not opened.");
+  m_file.write (&m_buffer[0], m_buffer.size ());
+  m_nBytesWritten += m_buffer.size ();
+  m_buffer.clear ();
+}
+
+void
+StatsVectorFile::Close ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer.joinable ())
+    {
+      m_stop.store (true, std::memory_order_release);
+      m_writer.join ();
+    }
+  if (IsOpen ())
+    {
+      WriteBuffer ();
+      m_file.close ();
+      m_opened = false;
+    }
+  std::vector<char> ().swap (m_buffer); // release buffer memory
+  std::vector<Record> ().swap (m_ring);
+}
+
+int64_t
+StatsVectorFile::ConvertToCsv (std::string binFileName, std::string csvFileName)
+{
+  NS_LOG_FUNCTION (binFileName << csvFileName);
+  std::ifstream in (binFileName.c_str (), std::ifstream::in | std::ifstream::binary);
+  char magic[sizeof (g_binMagic)];
+  uint32_t version = 0, recordSize = 0, byteOrderMark = 0, nameLength = 0;
+  in.read (magic, sizeof (magic));
+  in.read ((char *)&version, sizeof (version));
+  in.read ((char *)&recordSize, sizeof (recordSize));
+  in.read ((char *)&byteOrderMark, sizeof (byteOrderMark));
+  in.read ((char *)&nameLength, sizeof (nameLength));
+  if (!in || std::memcmp (magic, g_binMagic, sizeof (magic)) != 0 || version != g_binVersion
+      || recordSize != sizeof (Record) || byteOrderMark != g_binByteOrderMark || nameLength > 1024)
+    {
+      NS_LOG_WARN ("Not a valid binary vector file (or different byte order): " << binFileName);
+      return -1;
+    }
+  std::string valueName (nameLength, ' ');
+  in.read (&valueName[0], nameLength);
+
+  StatsVectorFile csv;
+  csv.Open (csvFileName, valueName);
+  Record record;
+  while (in.read ((char *)&record, sizeof (record)))
+    {
+      csv.AppendCsvRecord (record.rxTimeStep, record.flowIndex, record.seqNo, record.delayTimeStep);
+      csv.m_nRecords++;
+    }
+  csv.Close ();
+  return csv.m_nRecords;
+}
+
+} // namespace ns3
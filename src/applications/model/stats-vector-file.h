@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#ifndef STATS_VECTOR_FILE_H
+#define STATS_VECTOR_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <stdint.h>
+
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief Buffered writer for the vector file (one record for every received packet).
+ *
+ * The file is opened once per run and records are formatted into a large
+ * memory buffer which is written to the file only when it is full, on Flush ()
+ * or on Close (). The CSV file layout is the same as the one of the previous
+ * per-record writer (file opened and closed for every record):
+ * flow index, reception time [us], sequence number, one empty column for every
+ * flow index below the current one, delay [us].
+ *
+ * The binary layout is a file header (magic "STATSVEC", version, record size,
+ * byte order mark, value name) followed by fixed width records in host byte order:
+ * reception time step (int64), flow index (uint32), sequence number (uint32),
+ * delay time step (int64). Binary files can be converted to the CSV layout
+ * with ConvertToCsv () (see scratch/vec-to-csv.cc).
+ *
+ * In the asynchronous mode (SetAsync ()) Write () only stores the raw record into
+ * a lock-free single-producer/single-consumer ring and a writer thread, started
+ * by Open () and stopped by Close (), formats the records and writes them to the file.
+ * When the ring is full the simulator thread either waits for the writer (BLOCK)
+ * or the record is discarded and counted (DROP).
+ */
+class StatsVectorFile
+{
+public:
+  enum Format
+  {
+    CSV,   //!< text, comma separated values
+    BINARY //!< fixed width binary records
+  };
+
+  enum OverflowPolicy
+  {
+    BLOCK, //!< wait for the writer thread when the ring is full
+    DROP   //!< discard (and count) records while the ring is full
+  };
+
+  /**
+   * \brief Constructor
+   * \param bufferSize size of the memory buffer in bytes
+   */
+  StatsVectorFile (uint32_t bufferSize = 1 << 20);
+  ~StatsVectorFile ();
+
+  /**
+   * \brief Create (truncate) the file and write the file header.
+   * Aborts the simulation if the file cannot be created.
+   * \param fileName the file name
+   * \param valueName the name of the value column
+   */
+  void Open (std::string fileName, std::string valueName = "Delay [us]");
+  /**
+   * \return true between Open () and Close (). Kept by the simulator thread,
+   * m_file belongs to the writer thread in the asynchronous mode.
+   */
+  bool IsOpen () const { return m_opened; };
+
+  /**
+   * \brief Set the file format. Can be changed only while the file is closed.
+   * \param format CSV or BINARY
+   */
+  void SetFormat (Format format);
+  Format GetFormat () const { return m_format; };
+  /**
+   * \return file name extension for the current format (".csv" or ".bin")
+   */
+  std::string GetFileExtension () const { return m_format == BINARY ? ".bin" : ".csv"; };
+
+  /**
+   * \brief Enable or disable the writer thread. Can be changed only while the file is closed.
+   * \param async true to write the file from the writer thread
+   * \param ringSize number of records in the ring (rounded up to a power of two)
+   * \param policy what to do with new records while the ring is full
+   */
+  void SetAsync (bool async, uint32_t ringSize = 1 << 16, OverflowPolicy policy = BLOCK);
+  bool IsAsync () const { return m_async; };
+  OverflowPolicy GetOverflowPolicy () const { return m_policy; };
+
+  /**
+   * \brief Add one record to the buffer (or to the ring in the asynchronous mode)
+   * \param rxTime packet reception time
+   * \param flowIndex flow index
+   * \param seqNo packet sequence number
+   * \param delay packet delay
+   * \return false if the record was discarded (DROP policy and the ring is full)
+   */
+  bool Write (Time rxTime, uint32_t flowIndex, uint32_t seqNo, Time delay);
+
+  /**
+   * \brief Write buffered records to the file. In the asynchronous mode
+   * waits until the writer thread has written all queued records.
+   */
+  void Flush ();
+  /**
+   * \brief Flush buffered records and close the file
+   */
+  void Close ();
+
+  /**
+   * \brief Set the size of the memory buffer. Can be changed only while the file is closed.
+   * \param bufferSize the buffer size in bytes
+   */
+  void SetBufferSize (uint32_t bufferSize);
+  uint32_t GetBufferSize () const { return m_bufferSize; };
+
+  uint64_t GetNRecords () const { return m_nRecords; };
+  /**
+   * \return number of bytes written to the file (in the asynchronous mode valid after Close ())
+   */
+  uint64_t GetNBytesWritten () const { return m_nBytesWritten; };
+  /**
+   * \return number of records discarded because the ring was full (DROP policy)
+   */
+  uint64_t GetNDropped () const { return m_nDropped; };
+  /**
+   * \return number of records for which the simulator thread had to wait
+   * for the writer thread (BLOCK policy)
+   */
+  uint64_t GetNBlocked () const { return m_nBlocked; };
+
+  /**
+   * \brief Convert binary vector file to the CSV layout
+   * \param binFileName input binary file
+   * \param csvFileName output CSV file
+   * \return number of converted records, or -1 if the input is not a valid binary vector file
+   */
+  static int64_t ConvertToCsv (std::string binFileName, std::string csvFileName);
+
+private:
+  /// Unformatted record, as stored in the ring
+  struct Record
+  {
+    int64_t rxTimeStep;
+    uint32_t flowIndex;
+    uint32_t seqNo;
+    int64_t delayTimeStep;
+  };
+
+  void Append (const char *data, uint32_t len);
+  void AppendRecord (const Record &record);
+  void AppendCsvRecord (int64_t rxTimeStep, uint32_t flowIndex, uint32_t seqNo, int64_t delayTimeStep);
+  void WriteBuffer ();  //!< write m_buffer to the file
+  void WriterThread (); //!< writer thread main loop
+
+  std::ofstream m_file;
+  bool m_opened;              //!< File is opened (simulator thread)
+  Format m_format;            //!< File format
+  std::vector<char> m_buffer; //!< Formatted records not yet written to file
+  uint32_t m_bufferSize;      //!< Flush threshold in bytes
+  uint64_t m_nRecords;        //!< Number of records since Open ()
+  uint64_t m_nBytesWritten;   //!< Number of bytes written to file since Open ()
+
+  bool m_async;                  //!< Records are written by the writer thread
+  OverflowPolicy m_policy;       //!< Policy when the ring is full
+  std::vector<Record> m_ring;    //!< Records passed to the writer thread
+  uint64_t m_ringMask;           //!< Ring size - 1 (ring size is a power of two)
+  std::atomic<uint64_t> m_head;  //!< Next record to be written by Write () (simulator thread)
+  std::atomic<uint64_t> m_tail;  //!< Next record to be taken by the writer thread
+  std::atomic<bool> m_stop;      //!< Writer thread should exit when the ring is empty
+  std::atomic<bool> m_flushRequest; //!< Flush () waits for the writer thread to write its buffer
+  std::thread m_writer;          //!< Writer thread
+  uint64_t m_nDropped;           //!< Number of discarded records since Open ()
+  uint64_t m_nBlocked;           //!< Number of records that had to wait for free ring space since Open ()
+};
+
+} // namespace ns3
+
+#endif /* STATS_VECTOR_FILE_H */
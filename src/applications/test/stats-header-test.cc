@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <string>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/stats-header.h"
+
+using namespace ns3;
+
+namespace {
+
+// Number of bytes of an unsigned LEB128 varint
+uint32_t
+VarintBytes (uint64_t value)
+{
+  uint32_t bytes = 1;
+  for (; value >= 128; value /= 128)
+    {
+      bytes++;
+    }
+  return bytes;
+}
+
+// Receiver address of flow i, IPv4 and IPv6 alternately
+Address
+GetReceiver (uint32_t i)
+{
+  if (i % 2 == 0)
+    {
+      return InetSocketAddress (Ipv4Address (0x0a000001 + i), 1000 + i);
+    }
+  return Inet6SocketAddress (Ipv6Address (("2001:db8::" + std::to_string (i % 7 + 1)).c_str ()), 65535 - i);
+}
+
+} // anonymous namespace
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * StatsHeader round trip through a packet, full and compact (varint) format:
+ * the receiver gets the same sequence number, time stamp, sender ids and
+ * receiver address (and sink key) as the sender set, the serialized size is
+ * the number of bytes read, and the registry of the compact format is
+ * cleared by Simulator::Destroy ().
+ */
+class StatsHeaderRoundTripTestCase : public TestCase
+{
+public:
+  StatsHeaderRoundTripTestCase ();
+  virtual ~StatsHeaderRoundTripTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Send one header through a packet and compare the received fields
+   * \param flowId registered flow for the compact format
+   * \param seq the sequence number
+   * \param compact compact or full format
+   */
+  void RoundTrip (uint32_t flowId, uint32_t seq, bool compact);
+
+  std::vector<uint32_t> m_nodeIds; //!< Sender node of every registered flow
+  std::vector<Address> m_receivers; //!< Receiver of every registered flow
+  Time m_baseTime; //!< Base time of all registered flows
+  uint32_t m_nRoundTrips; //!< Number of checked headers
+};
+
+StatsHeaderRoundTripTestCase::StatsHeaderRoundTripTestCase ()
+  : TestCase ("StatsHeader full and compact format round trip"),
+    m_baseTime (Seconds (1.0)),
+    m_nRoundTrips (0)
+{
+}
+
+StatsHeaderRoundTripTestCase::~StatsHeaderRoundTripTestCase ()
+{
+}
+
+void
+StatsHeaderRoundTripTestCase::RoundTrip (uint32_t flowId, uint32_t seq, bool compact)
+{
+  m_nRoundTrips++;
+  StatsHeader sent; // time stamp is the current time
+  sent.SetSeq (seq);
+  sent.SetNodeId (m_nodeIds[flowId]);
+  sent.SetApplicationId (flowId);
+  sent.SetRxAddress (m_receivers[flowId]);
+  if (compact)
+    {
+      sent.SetCompact (flowId);
+      uint64_t offset = (Simulator::Now () - m_baseTime).GetTimeStep ();
+      NS_TEST_EXPECT_MSG_EQ (sent.GetSerializedSize (), 1 + VarintBytes (flowId) + VarintBytes (seq) + VarintBytes (offset),
+                             "Compact header size, flow " << flowId << ", seq " << seq << ", offset " << offset);
+    }
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddHeader (sent);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 100 + sent.GetSerializedSize (), "Packet size with the header");
+
+  StatsHeader received;
+  uint32_t bytesRead = packet->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (bytesRead, sent.GetSerializedSize (), "Bytes read, flow " << flowId << ", compact " << compact);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 100, "Payload after the header");
+  NS_TEST_EXPECT_MSG_EQ (received.IsCompact (), compact, "Format");
+  NS_TEST_EXPECT_MSG_EQ (received.GetSeq (), seq, "Sequence number, flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ (received.GetTs (), Simulator::Now (), "Time stamp, flow " << flowId << ", seq " << seq);
+  NS_TEST_EXPECT_MSG_EQ (received.GetNodeId (), m_nodeIds[flowId], "Sender node, flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ (received.GetApplicationId (), flowId, "Sender application, flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ ((received.GetRxAddress () == m_receivers[flowId]), true, "Receiver address, flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ (received.GetSinkKey (), StatsHeader::GetSinkKey (m_receivers[flowId]), "Sink key, flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ ((StatsHeader::GetSinkAddress (received.GetSinkKey ()) == m_receivers[flowId]), true,
+                         "Receiver address from the sink key, flow " << flowId);
+
+  StatsPacketInfo info;
+  received.GetPacketInfo (info);
+  NS_TEST_EXPECT_MSG_EQ (info.flowSlot, compact ? flowId : StatsPacketInfo::NO_FLOW_SLOT, "Flow slot, flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ (info.txTimeStep, Simulator::Now ().GetTimeStep (), "Packet info time stamp, flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ (info.sinkKey, received.GetSinkKey (), "Packet info sink key, flow " << flowId);
+}
+
+void
+StatsHeaderRoundTripTestCase::DoRun (void)
+{
+  // flow ids of one and two varint bytes, sender node ids up to the 32-bit limit
+  const uint32_t nFlows = 300;
+  for (uint32_t i = 0; i < nFlows; ++i)
+    {
+      m_nodeIds.push_back (i % 3 == 0 ? 0xffffffff - i : i);
+      m_receivers.push_back (GetReceiver (i));
+      NS_TEST_ASSERT_MSG_EQ (StatsHeader::RegisterFlow (m_nodeIds[i], i, m_receivers[i], m_baseTime), i, "Registered flow id");
+    }
+
+  // time stamp offsets and sequence numbers at the varint byte boundaries
+  const uint64_t offsets[] = {0, 127, 128, 16383, 16384, 2097151, 2097152, (uint64_t)1 << 35, ((uint64_t)1 << 42) + 1};
+  const uint32_t seqs[] = {0, 1, 127, 128, 16383, 16384, 0x7fffffff, 0xffffffff};
+  const uint32_t flows[] = {0, 1, 127, 128, 129, nFlows - 1};
+  for (uint32_t o = 0; o < sizeof (offsets) / sizeof (offsets[0]); ++o)
+    {
+      for (uint32_t s = 0; s < sizeof (seqs) / sizeof (seqs[0]); ++s)
+        {
+          for (uint32_t f = 0; f < sizeof (flows) / sizeof (flows[0]); ++f)
+            {
+              Time at = m_baseTime + TimeStep (offsets[o]);
+              Simulator::Schedule (at, &StatsHeaderRoundTripTestCase::RoundTrip, this, flows[f], seqs[s], true);
+              Simulator::Schedule (at, &StatsHeaderRoundTripTestCase::RoundTrip, this, flows[f], seqs[s], false);
+            }
+        }
+    }
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_nRoundTrips, 2 * 9 * 8 * 6, "Number of checked headers");
+  NS_TEST_ASSERT_MSG_EQ (StatsHeader::GetNRegisteredFlows (), nFlows, "Registry lives until Simulator::Destroy ()");
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (StatsHeader::GetNRegisteredFlows (), 0, "Registry cleared by Simulator::Destroy ()");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief StatsHeader test suite
+ */
+class StatsHeaderTestSuite : public TestSuite
+{
+public:
+  StatsHeaderTestSuite ();
+};
+
+StatsHeaderTestSuite::StatsHeaderTestSuite ()
+  : TestSuite ("stats-header", UNIT)
+{
+  AddTestCase (new StatsHeaderRoundTripTestCase, TestCase::QUICK);
+}
+
+static StatsHeaderTestSuite statsHeaderTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,371 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <string>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/stats-hist.h"
+
+using namespace ns3;
+
+namespace {
+
+// Quantiles compared between histograms (those of the scalar file and the ends)
+const double g_quantiles[] = {0.0, 0.1, 0.5, 0.9, 0.95, 0.99, 0.999, 1.0};
+const uint32_t g_nQuantiles = sizeof (g_quantiles) / sizeof (g_quantiles[0]);
+
+// Empty histogram of the given layout
+StatsHist
+MakeHist (double binWidth, uint8_t subBucketBits, bool sparse)
+{
+  StatsHist hist (binWidth);
+  hist.SetLogLinear (subBucketBits);
+  hist.SetSparse (sparse);
+  return hist;
+}
+
+} // anonymous namespace
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Sparse storage must give the same bins, median estimate and quantiles as
+ * the dense storage (GetSparseMedianEstimation is a separate walk over the
+ * occupied bins only). Small random histograms with runs of empty bins and
+ * equal counts on both sides, and continuous delay distributions.
+ */
+class StatsHistSparseTestCase : public TestCase
+{
+public:
+  /**
+   * \param subBucketBits 0 for fixed width bins, otherwise the log-linear layout
+   */
+  StatsHistSparseTestCase (uint8_t subBucketBits);
+  virtual ~StatsHistSparseTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Add the values to a dense and a sparse histogram and compare them
+   * \param values the values
+   * \param compareBins compare the count of every bin
+   * \param name data set name for the failure messages
+   */
+  void Compare (const std::vector<double> &values, bool compareBins, std::string name);
+
+  uint8_t m_subBucketBits; //!< Histogram layout
+  double m_binWidth;       //!< Bin width (narrowest bin of the log-linear layout)
+};
+
+StatsHistSparseTestCase::StatsHistSparseTestCase (uint8_t subBucketBits)
+  : TestCase (subBucketBits == 0 ? "Sparse against dense histogram, fixed width bins"
+                                 : "Sparse against dense histogram, log-linear bins"),
+    m_subBucketBits (subBucketBits),
+    m_binWidth (subBucketBits == 0 ? 0.0001 : 0.000001)
+{
+}
+
+StatsHistSparseTestCase::~StatsHistSparseTestCase ()
+{
+}
+
+void
+StatsHistSparseTestCase::Compare (const std::vector<double> &values, bool compareBins, std::string name)
+{
+  StatsHist dense = MakeHist (m_binWidth, m_subBucketBits, false);
+  StatsHist sparse = MakeHist (m_binWidth, m_subBucketBits, true);
+  for (uint32_t i = 0; i < values.size (); ++i)
+    {
+      dense.AddValue (values[i]);
+      sparse.AddValue (values[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sparse.GetNBins (), dense.GetNBins (), "Number of bins, " << name);
+  if (compareBins)
+    {
+      for (uint32_t i = 0; i < dense.GetNBins (); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (sparse.GetBinCount (i), dense.GetBinCount (i), "Count of bin " << i << ", " << name);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (sparse.GetMedianEstimation (), dense.GetMedianEstimation (), "Median estimate, " << name);
+  for (uint32_t q = 0; q < g_nQuantiles; ++q)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sparse.GetQuantile (g_quantiles[q]), dense.GetQuantile (g_quantiles[q]),
+                             "Quantile " << g_quantiles[q] << ", " << name);
+    }
+}
+
+void
+StatsHistSparseTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+  StatsHist layout = MakeHist (m_binWidth, m_subBucketBits, false);
+
+  // Few values in few bins: every branch of the median walk, including equal
+  // counts on both sides and runs of empty bins passed in one step
+  for (uint32_t n = 0; n < 2000; ++n)
+    {
+      std::vector<double> values;
+      uint32_t nBins = uniform->GetInteger (1, 12);
+      uint32_t stride = uniform->GetInteger (1, 40);
+      uint32_t index = uniform->GetInteger (0, 3);
+      for (uint32_t b = 0; b < nBins; ++b)
+        {
+          uint32_t count = uniform->GetInteger (0, 3);
+          for (uint32_t c = 0; c < count; ++c)
+            {
+              values.push_back (layout.GetBinMiddle (index));
+            }
+          index += uniform->GetInteger (1, stride);
+        }
+      Compare (values, true, "random bins " + std::to_string (n));
+      if (IsStatusFailure ())
+        {
+          return;
+        }
+    }
+
+  // Delay distributions
+  Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+  exponential->SetStream (2);
+  Ptr<LogNormalRandomVariable> logNormal = CreateObject<LogNormalRandomVariable> ();
+  logNormal->SetStream (3);
+  std::vector<double> exponentialDelays, heavyTailDelays, uniformDelays;
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      exponentialDelays.push_back (exponential->GetValue (0.005, 0.0)); // mean 5 ms
+      heavyTailDelays.push_back (logNormal->GetValue (std::log (0.002), 1.5)); // median 2 ms, outliers of seconds
+      uniformDelays.push_back (uniform->GetValue (0.001, 0.003));
+    }
+  Compare (exponentialDelays, true, "exponential delays");
+  Compare (heavyTailDelays, false, "heavy-tailed delays");
+  Compare (uniformDelays, true, "uniform delays");
+  std::vector<double> one (1, 0.0123);
+  Compare (one, true, "one value");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Log-linear layout: every value falls into the bin reported by GetBinStart
+ * and GetBinEnd, bin bounds increase, the bin width is at most 2^-subBucketBits
+ * of the value above the linear range and the number of bins grows with the
+ * logarithm of the largest value.
+ */
+class StatsHistLogLinearTestCase : public TestCase
+{
+public:
+  StatsHistLogLinearTestCase ();
+  virtual ~StatsHistLogLinearTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+StatsHistLogLinearTestCase::StatsHistLogLinearTestCase ()
+  : TestCase ("Log-linear histogram bin index and bin bounds")
+{
+}
+
+StatsHistLogLinearTestCase::~StatsHistLogLinearTestCase ()
+{
+}
+
+void
+StatsHistLogLinearTestCase::DoRun (void)
+{
+  const double binWidth = 0.000001; // 1 us
+  const uint8_t bits[] = {1, 3, 7, 10};
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (4);
+  for (uint32_t b = 0; b < sizeof (bits); ++b)
+    {
+      StatsHist layout = MakeHist (binWidth, bits[b], false);
+      double linearEnd = std::ldexp (2.0, bits[b]) * binWidth; // bins below are one unit wide
+      // bins up to the largest index (values are limited to 2^62 units)
+      uint32_t nBins = std::min (100000u, (64u - bits[b]) << bits[b]);
+      for (uint32_t i = 0; i < nBins; ++i)
+        {
+          NS_TEST_ASSERT_MSG_GT (layout.GetBinEnd (i), layout.GetBinStart (i), "Bin " << i << " is not empty");
+        }
+      for (uint32_t n = 0; n < 20000; ++n)
+        {
+          // log-uniform from 0.1 us to 100 s
+          double value = std::pow (10.0, uniform->GetValue (-7.0, 2.0));
+          StatsHist hist = MakeHist (binWidth, bits[b], false);
+          hist.AddValue (value);
+          uint32_t index = hist.GetNBins () - 1;
+          NS_TEST_ASSERT_MSG_EQ (hist.GetBinCount (index), 1, "Value " << value << " in the last bin");
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (hist.GetBinStart (index), value * (1 + 1e-12), "Bin start of " << value << ", " << (int)bits[b] << " bits");
+          NS_TEST_ASSERT_MSG_GT (hist.GetBinEnd (index), value * (1 - 1e-12), "Bin end of " << value << ", " << (int)bits[b] << " bits");
+          double width = hist.GetBinEnd (index) - hist.GetBinStart (index);
+          NS_TEST_ASSERT_MSG_EQ_TOL (hist.GetResolution (value), width, 1e-15, "Resolution of " << value);
+          if (value >= linearEnd)
+            {
+              NS_TEST_ASSERT_MSG_LT_OR_EQ (width, std::ldexp (value, -bits[b]) * (1 + 1e-12),
+                                           "Relative bin width at " << value << ", " << (int)bits[b] << " bits");
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL (width, binWidth, 1e-18, "Linear range bin width at " << value);
+            }
+        }
+    }
+
+  // 60 s at 1 us bins and 7 bits: a few thousand bins instead of 600000 bins of 0.1 ms
+  StatsHist hist = MakeHist (binWidth, 7, false);
+  hist.AddValue (60.0);
+  NS_TEST_ASSERT_MSG_LT (hist.GetNBins (), 3000, "Number of log-linear bins for 60 s");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * StatsHist::Merge of two histograms gives the count, mean, variance (Chan et al.),
+ * min and max of one histogram of all values, the same bins for the same layout,
+ * and the bins of the coarser histogram when fixed width bins are re-binned.
+ */
+class StatsHistMergeTestCase : public TestCase
+{
+public:
+  StatsHistMergeTestCase ();
+  virtual ~StatsHistMergeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Merge the histograms of two halves of the values and compare with
+   * the expected histogram of all values
+   * \param first histogram of the first half (layout of the merged histogram)
+   * \param second histogram of the second half
+   * \param all expected histogram of all values (layout of the merged result)
+   * \param values the values
+   * \param name layouts, for the failure messages
+   */
+  void Compare (StatsHist first, StatsHist second, StatsHist all, const std::vector<double> &values, std::string name);
+};
+
+StatsHistMergeTestCase::StatsHistMergeTestCase ()
+  : TestCase ("Histogram merge: statistics, bins and re-binning")
+{
+}
+
+StatsHistMergeTestCase::~StatsHistMergeTestCase ()
+{
+}
+
+void
+StatsHistMergeTestCase::Compare (StatsHist first, StatsHist second, StatsHist all, const std::vector<double> &values, std::string name)
+{
+  for (uint32_t i = 0; i < values.size (); ++i)
+    {
+      (i < values.size () / 3 ? first : second).AddValue (values[i]);
+      all.AddValue (values[i]);
+    }
+  first.Merge (second);
+  NS_TEST_ASSERT_MSG_EQ (first.GetCount (), all.GetCount (), "Count, " << name);
+  NS_TEST_ASSERT_MSG_EQ (first.GetMin (), all.GetMin (), "Min, " << name);
+  NS_TEST_ASSERT_MSG_EQ (first.GetMax (), all.GetMax (), "Max, " << name);
+  NS_TEST_ASSERT_MSG_EQ_TOL (first.GetSum (), all.GetSum (), 1e-12 * all.GetSum (), "Sum, " << name);
+  NS_TEST_ASSERT_MSG_EQ_TOL (first.GetMean (), all.GetMean (), 1e-12 * all.GetMean (), "Mean, " << name);
+  NS_TEST_ASSERT_MSG_EQ_TOL (first.GetVariance (), all.GetVariance (), 1e-9 * all.GetVariance (), "Variance, " << name);
+  NS_TEST_ASSERT_MSG_EQ (first.GetBinWidth (), all.GetBinWidth (), "Bin width, " << name);
+  NS_TEST_ASSERT_MSG_EQ (first.GetNBins (), all.GetNBins (), "Number of bins, " << name);
+  for (uint32_t i = 0; i < all.GetNBins (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (first.GetBinCount (i), all.GetBinCount (i), "Count of bin " << i << ", " << name);
+    }
+  NS_TEST_ASSERT_MSG_EQ (first.GetMedianEstimation (), all.GetMedianEstimation (), "Median estimate, " << name);
+  for (uint32_t q = 0; q < g_nQuantiles; ++q)
+    {
+      NS_TEST_ASSERT_MSG_EQ (first.GetQuantile (g_quantiles[q]), all.GetQuantile (g_quantiles[q]),
+                             "Quantile " << g_quantiles[q] << ", " << name);
+    }
+}
+
+void
+StatsHistMergeTestCase::DoRun (void)
+{
+  Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+  exponential->SetStream (5);
+  std::vector<double> values;
+  for (uint32_t i = 0; i < 3000; ++i)
+    {
+      // delays around 20 ms, far from zero, so the variance is sensitive to cancellation
+      values.push_back (0.02 + exponential->GetValue (0.002, 0.0));
+    }
+
+  // same layout, every storage combination
+  for (uint32_t s = 0; s < 4; ++s)
+    {
+      bool firstSparse = s & 1, secondSparse = s & 2;
+      std::string storage = std::string (firstSparse ? "sparse" : "dense") + "+" + (secondSparse ? "sparse" : "dense");
+      Compare (MakeHist (0.0001, 0, firstSparse), MakeHist (0.0001, 0, secondSparse),
+               MakeHist (0.0001, 0, firstSparse), values, "fixed width, " + storage);
+      Compare (MakeHist (0.000001, 7, firstSparse), MakeHist (0.000001, 7, secondSparse),
+               MakeHist (0.000001, 7, firstSparse), values, "log-linear, " + storage);
+    }
+  // empty histogram takes the layout of the other one
+  StatsHist empty = MakeHist (0.0001, 0, false);
+  Compare (empty, MakeHist (0.000001, 7, false), MakeHist (0.000001, 7, false), std::vector<double> (values.begin (), values.begin () + 1), "empty");
+
+  // fixed width re-binned to the coarser bins of the other histogram (10 x 0.1 ms),
+  // values on the bin middles so that no value is on a bin boundary
+  std::vector<double> middles;
+  for (uint32_t i = 0; i < values.size (); ++i)
+    {
+      middles.push_back ((std::floor (values[i] / 0.0001) + 0.5) * 0.0001);
+    }
+  Compare (MakeHist (0.0001, 0, false), MakeHist (0.001, 0, false), MakeHist (0.001, 0, false), middles, "re-binned, dense");
+  Compare (MakeHist (0.0001, 0, true), MakeHist (0.001, 0, false), MakeHist (0.001, 0, true), middles, "re-binned, sparse");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief StatsHist test suite
+ */
+class StatsHistTestSuite : public TestSuite
+{
+public:
+  StatsHistTestSuite ();
+};
+
+StatsHistTestSuite::StatsHistTestSuite ()
+  : TestSuite ("stats-hist", UNIT)
+{
+  AddTestCase (new StatsHistSparseTestCase (0), TestCase::QUICK);
+  AddTestCase (new StatsHistSparseTestCase (7), TestCase::QUICK);
+  AddTestCase (new StatsHistLogLinearTestCase, TestCase::QUICK);
+  AddTestCase (new StatsHistMergeTestCase, TestCase::QUICK);
+}
+
+static StatsHistTestSuite statsHistTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018 University of Belgrade, Faculty of Transport and Traffic Engineering
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Nenad Jevtic <n.jevtic@sf.bg.ac.rs>
+ *                       <nen.jevtic@gmail.com>
+ *          Marija Malnar <m.malnar@sf.bg.ac.rs>
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "ns3/test.h"
+#include "ns3/stats-replication.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Student t quantiles against the table values (4 decimals) for small and
+ * large degrees of freedom, symmetry around zero and the normal limit.
+ */
+class StatsStudentTTestCase : public TestCase
+{
+public:
+  StatsStudentTTestCase ();
+  virtual ~StatsStudentTTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+StatsStudentTTestCase::StatsStudentTTestCase ()
+  : TestCase ("Student t quantile")
+{
+}
+
+StatsStudentTTestCase::~StatsStudentTTestCase ()
+{
+}
+
+void
+StatsStudentTTestCase::DoRun (void)
+{
+  struct
+  {
+    double p;
+    uint32_t dof;
+    double t;
+  } table[] = {
+    {0.975, 1, 12.7062}, {0.975, 2, 4.3027}, {0.95, 4, 2.1318}, {0.975, 5, 2.5706},
+    {0.975, 10, 2.2281}, {0.995, 10, 3.1693}, {0.9, 20, 1.3253}, {0.975, 30, 2.0423},
+    {0.995, 60, 2.6603}, {0.975, 1000, 1.9623}, {0.975, 100000, 1.9600}
+  };
+  for (uint32_t i = 0; i < sizeof (table) / sizeof (table[0]); ++i)
+    {
+      double t = StatsRunningStat::GetStudentTQuantile (table[i].p, table[i].dof);
+      NS_TEST_EXPECT_MSG_EQ_TOL (t, table[i].t, 1e-4 * table[i].t + 5e-5,
+                                 "t (" << table[i].p << ", " << table[i].dof << ")");
+      NS_TEST_EXPECT_MSG_EQ_TOL (StatsRunningStat::GetStudentTQuantile (1.0 - table[i].p, table[i].dof), -t, 1e-9 * t,
+                                 "Symmetry of t (" << table[i].p << ", " << table[i].dof << ")");
+    }
+  // median, and quantiles decreasing with the degrees of freedom
+  NS_TEST_EXPECT_MSG_EQ_TOL (StatsRunningStat::GetStudentTQuantile (0.5, 3), 0.0, 1e-9, "Median");
+  for (uint32_t dof = 1; dof < 200; ++dof)
+    {
+      NS_TEST_EXPECT_MSG_GT (StatsRunningStat::GetStudentTQuantile (0.975, dof),
+                             StatsRunningStat::GetStudentTQuantile (0.975, dof + 1), "t (0.975, " << dof << ")");
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Running mean, variance, min, max and confidence interval half-width of
+ * values with a large common offset (Welford's update keeps the variance).
+ */
+class StatsRunningStatTestCase : public TestCase
+{
+public:
+  StatsRunningStatTestCase ();
+  virtual ~StatsRunningStatTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+StatsRunningStatTestCase::StatsRunningStatTestCase ()
+  : TestCase ("Running statistics and confidence interval")
+{
+}
+
+StatsRunningStatTestCase::~StatsRunningStatTestCase ()
+{
+}
+
+void
+StatsRunningStatTestCase::DoRun (void)
+{
+  StatsRunningStat stat;
+  NS_TEST_EXPECT_MSG_EQ (stat.GetVariance (), 0.0, "Variance of no values");
+  NS_TEST_EXPECT_MSG_EQ (stat.GetHalfWidth (0.95), std::numeric_limits<double>::infinity (), "Half-width of no values");
+  stat.Add (7.0);
+  NS_TEST_EXPECT_MSG_EQ (stat.GetVariance (), 0.0, "Variance of one value");
+  NS_TEST_EXPECT_MSG_EQ (stat.GetHalfWidth (0.95), std::numeric_limits<double>::infinity (), "Half-width of one value");
+
+  // 1e9 + {2, 4, 4, 4, 5, 5, 7, 9}: mean 1e9 + 5, sample variance 32 / 7
+  const double offset = 1e9;
+  const double values[] = {2, 4, 4, 4, 5, 5, 7, 9};
+  stat.Clear ();
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      stat.Add (offset + values[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (stat.GetCount (), 8, "Count");
+  NS_TEST_EXPECT_MSG_EQ_TOL (stat.GetMean (), offset + 5.0, 1e-6, "Mean");
+  NS_TEST_EXPECT_MSG_EQ_TOL (stat.GetVariance (), 32.0 / 7.0, 1e-6, "Variance");
+  NS_TEST_EXPECT_MSG_EQ (stat.GetMin (), offset + 2.0, "Min");
+  NS_TEST_EXPECT_MSG_EQ (stat.GetMax (), offset + 9.0, "Max");
+  // t (0.975, 7) = 2.3646
+  double halfWidth = 2.3646 * std::sqrt (32.0 / 7.0 / 8.0);
+  NS_TEST_EXPECT_MSG_EQ_TOL (stat.GetHalfWidth (0.95), halfWidth, 1e-4 * halfWidth, "Half-width");
+  NS_TEST_EXPECT_MSG_EQ_TOL (stat.GetRelativeHalfWidth (0.95), halfWidth / (offset + 5.0), 1e-4 * halfWidth / offset,
+                             "Relative half-width");
+
+  // equal values: zero variance and half-width, also with zero mean
+  stat.Clear ();
+  stat.Add (0.0);
+  stat.Add (0.0);
+  NS_TEST_EXPECT_MSG_EQ (stat.GetHalfWidth (0.95), 0.0, "Half-width of equal values");
+  NS_TEST_EXPECT_MSG_EQ (stat.GetRelativeHalfWidth (0.95), 0.0, "Relative half-width of equal zero values");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief StatsRunningStat test suite
+ */
+class StatsReplicationTestSuite : public TestSuite
+{
+public:
+  StatsReplicationTestSuite ();
+};
+
+StatsReplicationTestSuite::StatsReplicationTestSuite ()
+  : TestSuite ("stats-replication", UNIT)
+{
+  AddTestCase (new StatsStudentTTestCase, TestCase::QUICK);
+  AddTestCase (new StatsRunningStatTestCase, TestCase::QUICK);
+}
+
+static StatsReplicationTestSuite statsReplicationTestSuite; //!< Static variable for test initialization